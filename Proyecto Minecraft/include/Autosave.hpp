@@ -0,0 +1,279 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SaveFormat.hpp"
+#include "World.hpp"
+
+// Autoguardado incremental. Una partida en disco es un archivo base (formato de
+// SaveFormat.hpp: cabecera + mundo + estado del juego) más un journal
+// (`<base>.journal`) al que se añaden registros con solo los chunks modificados
+// desde el registro anterior y el estado del juego de ese momento.
+//
+// El hilo principal no copia bloques: la instantánea guarda referencias
+// compartidas a los chunks (World::share_chunk), el World solo copia un chunk si
+// se edita mientras la instantánea sigue viva, y la encola; el hilo escritor la
+// codifica y la añade al journal, y cuando el journal crece demasiado lo compacta (base + journal -> nueva base,
+// escrita a un temporal y renombrada). Ante un cierre inesperado se pierde
+// como mucho lo editado desde el último registro; un registro a medio escribir
+// se descarta por su checksum.
+
+namespace journal {
+
+const std::uint32_t RECORD_MAGIC = 0x4C4E524A; // "JRNL"
+
+inline std::uint32_t checksum(const std::uint8_t *p, std::size_t n) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+inline std::string journal_path(const std::string &basePath) { return basePath + ".journal"; }
+
+// Copia de lo que hay que guardar, independiente del World vivo
+struct Snapshot {
+    struct Item { int cx, cy; std::shared_ptr<const Chunk> chunk; }; // chunk nulo = todo aire
+    bool full = false; // true: nueva base completa; false: registro del journal
+    save::Header header;
+    int width = 0, height = 0;
+    std::vector<Item> chunks;
+    std::vector<std::uint8_t> meta; // estado del juego serializado (jugador, enemigos...)
+};
+
+// Instantánea de todo el mundo (nueva base); limpia la lista de chunks sucios
+inline Snapshot snapshot_full(World &world, const save::Header &h, std::vector<std::uint8_t> meta) {
+    Snapshot s;
+    s.full = true; s.header = h; s.width = world.width(); s.height = world.height();
+    world.for_each_generated([&](int cx, int cy, const Chunk *) {
+        s.chunks.push_back(Snapshot::Item{cx, cy, world.share_chunk(cx, cy)});
+    });
+    world.take_dirty();
+    s.meta = std::move(meta);
+    return s;
+}
+
+// Instantánea de los chunks modificados desde la anterior
+inline Snapshot snapshot_dirty(World &world, const save::Header &h, std::vector<std::uint8_t> meta) {
+    Snapshot s;
+    s.header = h; s.width = world.width(); s.height = world.height();
+    for (std::uint64_t k : world.take_dirty()) {
+        int cx = (std::int32_t)(k >> 32), cy = (std::int32_t)(std::uint32_t)k;
+        s.chunks.push_back(Snapshot::Item{cx, cy, world.share_chunk(cx, cy)});
+    }
+    s.meta = std::move(meta);
+    return s;
+}
+
+inline void write_base(ByteWriter &out, const save::Header &h, const World &world, const std::vector<std::uint8_t> &meta) {
+    save::write_header(out, h);
+    save::write_world(out, world);
+    out.raw(meta.data(), meta.size());
+}
+
+// Lo mismo a partir de una instantánea completa (mismo formato que save::write_world)
+inline void write_base(ByteWriter &out, const Snapshot &s) {
+    save::write_header(out, s.header);
+    out.i32(s.width);
+    out.i32(s.height);
+    out.u32((std::uint32_t)s.chunks.size());
+    std::vector<std::uint8_t> tmp;
+    for (const Snapshot::Item &it : s.chunks) save::write_chunk(out, it.cx, it.cy, it.chunk.get(), tmp);
+    out.raw(s.meta.data(), s.meta.size());
+}
+
+inline bool write_file_atomic(const std::string &path, const ByteWriter &out) {
+    std::string tmp = path + ".tmp";
+    if (!out.write_file(tmp)) return false;
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+// Lee la base y le aplica los registros válidos del journal (los de ticks ya
+// incluidos en la base se ignoran). `records` recibe cuántos se aplicaron.
+inline bool read_merged(const std::string &basePath, save::Header &h, World &world, std::vector<std::uint8_t> &meta, int *records = nullptr) {
+    std::vector<std::uint8_t> bytes;
+    if (!read_file(basePath, bytes)) return false;
+    ByteReader in(bytes.data(), bytes.size());
+    if (!save::read_header(in, h) || !save::read_world(in, world)) return false;
+    meta.assign(bytes.end() - in.remaining(), bytes.end());
+    if (records) *records = 0;
+
+    std::vector<std::uint8_t> jbytes;
+    if (!read_file(journal_path(basePath), jbytes)) return true; // sin journal
+    ByteReader jr(jbytes.data(), jbytes.size());
+    while (jr.remaining() >= 12) {
+        if (jr.u32() != RECORD_MAGIC) break;
+        std::uint32_t size = jr.u32(), sum = jr.u32();
+        const std::uint8_t *payload = jr.take(size);
+        if (!payload || checksum(payload, size) != sum) break; // registro incompleto: fin del journal
+        ByteReader rec(payload, size);
+        std::uint64_t seed = rec.u64(), tick = rec.u64();
+        std::uint32_t count = rec.u32();
+        if (!rec.ok || seed != h.seed) break;
+        bool apply = tick > h.tick;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            int cx, cy;
+            std::unique_ptr<Chunk> c;
+            if (!save::read_chunk(rec, cx, cy, c)) return false;
+            if (apply) save::put_chunk(world, cx, cy, std::move(c));
+        }
+        std::uint32_t metaSize = rec.u32();
+        const std::uint8_t *m = rec.take(metaSize);
+        if (!m) return false;
+        if (!apply) continue;
+        meta.assign(m, m + metaSize);
+        h.tick = tick;
+        if (records) (*records)++;
+    }
+    world.take_dirty();
+    return true;
+}
+
+} // namespace journal
+
+class Autosaver {
+public:
+    // `compactBytes`: tamaño del journal a partir del cual se reescribe la base
+    Autosaver(const std::string &basePath, std::size_t compactBytes = 4u << 20)
+        : base(basePath), compactAt(compactBytes) {
+        std::error_code ec;
+        hasBase = std::filesystem::exists(base, ec);
+        journalBytes = hasBase ? (std::size_t)std::filesystem::file_size(journal::journal_path(base), ec) : 0;
+        if (ec) journalBytes = 0;
+        writer = std::thread([this] { run(); });
+    }
+
+    ~Autosaver() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        writer.join(); // termina de escribir lo encolado
+    }
+
+    Autosaver(const Autosaver &) = delete;
+    Autosaver &operator=(const Autosaver &) = delete;
+
+    // Encola una instantánea; no toca el disco en este hilo
+    void submit(journal::Snapshot s) {
+        if (s.full) hasBase = true;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            jobs.push_back(std::move(s));
+        }
+        cv.notify_all();
+    }
+
+    // Espera a que todo lo encolado esté en disco (p.ej. antes de cargar la partida)
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx);
+        idle.wait(lock, [this] { return jobs.empty() && !busy; });
+    }
+
+    // Si todavía no hay base en disco, el primer guardado debe ser completo
+    bool has_base() const { return hasBase; }
+    const std::string &path() const { return base; }
+    bool failed() const { return error.load(); }
+
+private:
+    void run() {
+        for (;;) {
+            journal::Snapshot s;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return; // stopping y sin trabajo pendiente
+                s = std::move(jobs.front());
+                jobs.pop_front();
+                busy = true;
+            }
+            bool ok = s.full ? write_full(s) : append(s);
+            if (ok && !s.full && journalBytes >= compactAt) ok = compact();
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                busy = false;
+                if (!ok) error = true;
+            }
+            idle.notify_all();
+        }
+    }
+
+    bool write_full(const journal::Snapshot &s) {
+        ByteWriter out;
+        journal::write_base(out, s);
+        std::error_code ec;
+        auto dir = std::filesystem::path(base).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+        if (!journal::write_file_atomic(base, out)) return false;
+        return truncate_journal();
+    }
+
+    bool append(const journal::Snapshot &s) {
+        ByteWriter payload;
+        payload.u64(s.header.seed);
+        payload.u64(s.header.tick);
+        payload.u32((std::uint32_t)s.chunks.size());
+        std::vector<std::uint8_t> tmp;
+        for (auto &it : s.chunks) save::write_chunk(payload, it.cx, it.cy, it.chunk.get(), tmp);
+        payload.u32((std::uint32_t)s.meta.size());
+        payload.raw(s.meta.data(), s.meta.size());
+        ByteWriter rec;
+        rec.u32(journal::RECORD_MAGIC);
+        rec.u32((std::uint32_t)payload.data().size());
+        rec.u32(journal::checksum(payload.data().data(), payload.data().size()));
+        rec.raw(payload.data().data(), payload.data().size());
+
+        std::FILE *f = std::fopen(journal::journal_path(base).c_str(), "ab");
+        if (!f) return false;
+        bool ok = std::fwrite(rec.data().data(), 1, rec.data().size(), f) == rec.data().size();
+        ok = std::fflush(f) == 0 && ok;
+        std::fclose(f);
+        journalBytes += rec.data().size();
+        return ok;
+    }
+
+    // base + journal -> nueva base; el journal queda vacío
+    bool compact() {
+        save::Header h;
+        World w;
+        std::vector<std::uint8_t> meta;
+        if (!journal::read_merged(base, h, w, meta)) return false;
+        ByteWriter out;
+        journal::write_base(out, h, w, meta);
+        if (!journal::write_file_atomic(base, out)) return false;
+        return truncate_journal();
+    }
+
+    bool truncate_journal() {
+        std::FILE *f = std::fopen(journal::journal_path(base).c_str(), "wb");
+        if (!f) return false;
+        std::fclose(f);
+        journalBytes = 0;
+        return true;
+    }
+
+    std::string base;
+    std::size_t compactAt;
+    std::size_t journalBytes = 0; // solo hilo escritor (y constructor)
+    bool hasBase = false;         // solo hilo principal
+    std::thread writer;
+    std::mutex mtx;
+    std::condition_variable cv, idle;
+    std::deque<journal::Snapshot> jobs; // protegido por mtx
+    bool busy = false, stopping = false;
+    std::atomic<bool> error{false};
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Índice del bit más bajo a 1 (`v` != 0)
+inline int lowest_bit(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    int i = 0;
+    while (!(v & 1)) { v >>= 1; ++i; }
+    return i;
+#endif
+}
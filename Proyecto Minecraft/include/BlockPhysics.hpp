@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "BlockTraits.hpp"
+#include "World.hpp"
+
+// Bloques que se mueven solos: fluidos (lava, agua) y bloques que caen (arena, nieve).
+//
+// Nada recorre el mapa: cada World::set() deja su tile en la cola del mundo y
+// update() solo mira esos tiles y sus vecinos. Un fluido que no cambió en su paso
+// no vuelve a encolarse (se duerme), así que un lago o el infierno lleno de lava
+// quietos no cuestan nada; lo que se mueve vuelve a despertarse a sí mismo y a sus
+// vecinos con sus propios set().
+//
+// Fluidos: autómata celular con nivel 1..FLUID_MAX por tile y masa conservada.
+// Un paso de un tile cae todo lo que cabe debajo y reparte el resto a partes
+// iguales con los vecinos laterales más bajos (un charco de nivel 1 ya no se
+// mueve). Cada fluido da un paso cada BlockTraits::flowPeriod ticks; lava y agua
+// en contacto hacen piedra. Los tiles activos se procesan por rondas, de abajo
+// arriba, con FLUID_BUDGET tiles por tick como mucho: vaciar una cueva grande
+// tarda más ticks, pero el coste por tick está acotado.
+//
+// Bloques que caen: se encola el tile cuyo soporte cambió; la columna entera de
+// bloques que caen encima baja de una vez hasta el primer tile que la sostiene
+// (los fluidos que había en medio suben por encima). Como mucho FALL_BUDGET
+// columnas por tick, así que un derrumbe grande termina en pocos ticks.
+//
+// El orden de proceso solo depende de las posiciones, así que es determinista.
+class BlockPhysics {
+public:
+    static const int FLUID_BUDGET = 4096; // pasos de fluido por tick como mucho
+    static const int FALL_BUDGET = 256;   // columnas derrumbadas por tick como mucho
+
+    // Olvida lo pendiente y despierta los fluidos a medio nivel del mundo (al crear o cargar)
+    void reset(World &world) {
+        world.take_block_updates();
+        falls.clear();
+        for (auto &q : queues) { q.current.clear(); q.next.clear(); q.cursor = 0; }
+        world.for_each_generated([&](int cx, int cy, const Chunk *c) {
+            if (!c) return;
+            for (int i = 0; i < CHUNK * CHUNK; ++i)
+                if (c->fluid[i] && is_fluid(c->tiles[i])) queues[c->tiles[i]].next.push_back(pack(cx * CHUNK + (i & (CHUNK - 1)), cy * CHUNK + i / CHUNK));
+        });
+    }
+
+    // Un tick de simulación: despierta lo que tocaron las ediciones, derrumba columnas y mueve fluidos
+    void update(World &world, std::uint64_t tick) {
+        for (TilePos t : world.take_block_updates()) wake(world, t.x, t.y);
+        collapse_pending(world);
+        int budget = FLUID_BUDGET;
+        for (int b = 0; b < BLOCK_COUNT && budget > 0; ++b) {
+            int period = block_traits((BlockId)b).flowPeriod;
+            if (period && tick % (std::uint64_t)period == 0) step_queue(world, (BlockId)b, budget);
+        }
+    }
+
+    // Tiles de fluido pendientes de un paso y columnas pendientes de caer
+    std::size_t active_fluids() const {
+        std::size_t n = 0;
+        for (const auto &q : queues) n += q.current.size() - q.cursor + q.next.size();
+        return n;
+    }
+    std::size_t pending_falls() const { return falls.size(); }
+
+private:
+    struct Queue {
+        std::vector<std::uint64_t> current, next; // ronda en curso (ordenada) y la siguiente
+        std::size_t cursor = 0;
+    };
+
+    // Clave de un tile que ordena de abajo arriba y, en cada fila, de izquierda a derecha
+    static std::uint64_t pack(int x, int y) { return ((std::uint64_t)(std::uint32_t)(0x7FFFFFFF - y) << 32) | (std::uint32_t)x; }
+    static int key_x(std::uint64_t k) { return (int)(std::uint32_t)k; }
+    static int key_y(std::uint64_t k) { return 0x7FFFFFFF - (int)(k >> 32); }
+
+    static BlockId at(const World &world, int x, int y) { return world.in_bounds(x, y) ? world.get(x, y) : (BlockId)BEDR; }
+    // ¿Sostiene a un bloque que cae? Todo menos aire y fluidos (fuera del mundo, sí)
+    static bool supports(const World &world, int x, int y) {
+        BlockId b = at(world, x, y);
+        return b != AIR && !is_fluid(b);
+    }
+
+    static void sort_unique(std::vector<std::uint64_t> &v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+
+    // El tile (x, y) cambió: fluidos en él y alrededor, y bloques que caen en él o encima
+    void wake(const World &world, int x, int y) {
+        static const int DX[5] = {0, -1, 1, 0, 0}, DY[5] = {0, 0, 0, -1, 1};
+        for (int k = 0; k < 5; ++k) {
+            int nx = x + DX[k], ny = y + DY[k];
+            if (!world.in_bounds(nx, ny)) continue;
+            BlockId b = world.get(nx, ny);
+            if (is_fluid(b)) queues[b].next.push_back(pack(nx, ny));
+        }
+        if (block_traits(at(world, x, y)).falls) falls.push_back(pack(x, y));
+        if (block_traits(at(world, x, y - 1)).falls) falls.push_back(pack(x, y - 1));
+    }
+
+    void collapse_pending(World &world) {
+        if (falls.empty()) return;
+        sort_unique(falls); // de abajo arriba: las columnas de abajo se asientan antes
+        std::size_t n = std::min(falls.size(), (std::size_t)FALL_BUDGET);
+        for (std::size_t i = 0; i < n; ++i) collapse(world, key_x(falls[i]), key_y(falls[i]));
+        falls.erase(falls.begin(), falls.begin() + n);
+    }
+
+    // Si el bloque que cae en (x, y) no tiene soporte, baja la columna de bloques que
+    // caen que empieza en él hasta el primer tile que la sostiene
+    void collapse(World &world, int x, int y) {
+        if (!block_traits(at(world, x, y)).falls || supports(world, x, y + 1)) return;
+        int top = y;
+        while (block_traits(at(world, x, top - 1)).falls) --top;
+        int ground = y + 1;
+        while (!supports(world, x, ground)) ++ground;
+        // [top, y]: bloques que caen; [y + 1, ground - 1]: aire o fluido que pasa arriba
+        column.clear();
+        for (int r = y + 1; r < ground; ++r) column.push_back(Cell{world.get(x, r), world.fluid_level(x, r)});
+        for (int r = top; r <= y; ++r) column.push_back(Cell{world.get(x, r), 0});
+        for (std::size_t i = 0; i < column.size(); ++i) world.set(x, top + (int)i, column[i].block, column[i].level);
+    }
+
+    // Procesa la ronda de un fluido hasta agotarla o agotar el presupuesto
+    void step_queue(World &world, BlockId b, int &budget) {
+        Queue &q = queues[b];
+        if (q.cursor >= q.current.size()) {
+            q.current.swap(q.next);
+            q.next.clear();
+            q.cursor = 0;
+            sort_unique(q.current);
+        }
+        while (q.cursor < q.current.size() && budget > 0) {
+            std::uint64_t k = q.current[q.cursor++];
+            step_fluid(world, b, key_x(k), key_y(k));
+            budget--;
+        }
+    }
+
+    void step_fluid(World &world, BlockId f, int x, int y) {
+        if (at(world, x, y) != f) return; // ya no está (lo movió otro paso o una edición)
+        int level = world.fluid_level(x, y);
+        // lava y agua en contacto: la lava se vuelve piedra
+        static const int DX[4] = {-1, 1, 0, 0}, DY[4] = {0, 0, -1, 1};
+        for (int k = 0; k < 4; ++k) {
+            BlockId n = at(world, x + DX[k], y + DY[k]);
+            if (!is_fluid(n) || n == f) continue;
+            if (f == LAVA) { world.set(x, y, STONE); return; }
+            if (n == LAVA) world.set(x + DX[k], y + DY[k], STONE);
+        }
+        // caer: todo lo que cabe en el tile de abajo
+        BlockId below = at(world, x, y + 1);
+        if (below == AIR || below == f) {
+            int room = FLUID_MAX - (below == f ? world.fluid_level(x, y + 1) : 0);
+            int moved = std::min(level, room);
+            if (moved > 0) {
+                world.set(x, y + 1, f, FLUID_MAX - room + moved);
+                level -= moved;
+                if (level == 0) { world.set(x, y, AIR); return; }
+            }
+        }
+        // repartir con los vecinos laterales más bajos (el resto, primero para sí)
+        int side[2], sideLevel[2], count = 0, total = level;
+        int first = (int)((x + y) & 1) ? 1 : -1; // alterna qué lado recibe el sobrante
+        for (int s : {first, -first}) {
+            BlockId n = at(world, x + s, y);
+            int nl = n == AIR ? 0 : n == f ? world.fluid_level(x + s, y) : -1;
+            if (nl < 0 || nl >= level) continue;
+            side[count] = x + s;
+            sideLevel[count++] = nl;
+            total += nl;
+        }
+        if (count == 0) { world.set(x, y, f, level); return; }
+        int share = total / (count + 1), rest = total % (count + 1);
+        int mine = share + (rest > 0 ? 1 : 0);
+        if (rest > 0) rest--;
+        world.set(x, y, f, mine);
+        for (int i = 0; i < count; ++i) {
+            int v = share + (rest > 0 ? 1 : 0);
+            if (rest > 0) rest--;
+            if (v == sideLevel[i]) continue;
+            if (v == 0) world.set(side[i], y, AIR);
+            else world.set(side[i], y, f, v);
+        }
+    }
+
+    struct Cell { BlockId block; int level; };
+
+    std::array<Queue, BLOCK_COUNT> queues; // por id de bloque (solo se usan los fluidos)
+    std::vector<std::uint64_t> falls;      // tiles cuyo soporte cambió
+    std::vector<Cell> column;
+};
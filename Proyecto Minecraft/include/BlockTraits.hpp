@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Ids de bloque densos (0..BLOCK_COUNT-1) y sus propiedades en una tabla de
+// compilación indexada por id. Render, colisión, picado, HUD e inventario leen de
+// aquí en vez de mapas y cadenas de ifs repartidos por el código: consultar una
+// propiedad es cargar un elemento de un array.
+// Los ids se guardan tal cual en las partidas: añadir bloques siempre al final.
+
+typedef std::uint8_t BlockId;
+
+enum Block : BlockId {
+    AIR = 0, GRASS, DIRT, STONE, WOOD, BEDR, LEAF, COAL, IRON, GOLD,
+    // bloques de biomas
+    SAND, SNOW, NETH, LAVA,
+    WATER,
+    BLOCK_COUNT
+};
+
+enum Tool : std::uint8_t { TOOL_NONE = 0, TOOL_PICKAXE, TOOL_AXE, TOOL_SHOVEL, TOOL_SWORD, TOOL_COUNT };
+
+struct ToolInfo {
+    const char *id;   // clave en las partidas guardadas y en los escenarios
+    const char *name; // nombre para el HUD
+};
+
+inline constexpr std::array<ToolInfo, TOOL_COUNT> TOOL_INFO = {{
+    {"", "(none)"}, {"pickaxe", "Pico"}, {"axe", "Hacha"}, {"shovel", "Pala"}, {"sword", "Espada"}
+}};
+
+inline Tool tool_from_id(const std::string &id) {
+    for (int t = TOOL_PICKAXE; t < TOOL_COUNT; ++t) if (id == TOOL_INFO[t].id) return (Tool)t;
+    return TOOL_NONE;
+}
+
+struct Rgb { std::uint8_t r, g, b; };
+
+struct BlockTraits {
+    Rgb color = {255, 0, 255};  // color liso (sin textura)
+    float hardness = 1.0f;      // multiplicador del tiempo de picado; < 0 = no se puede picar
+    Tool tool = TOOL_NONE;      // herramienta que lo pica más rápido
+    bool solid = true;          // bloquea el movimiento
+    std::uint8_t light = 0;     // luz que emite (0..15)
+    BlockId drop = AIR;         // bloque que va al inventario al picarlo (AIR = nada)
+    const char *name = nullptr; // nombre para el HUD
+    std::uint8_t flowPeriod = 0; // fluido: ticks entre dos pasos de su simulación (0 = no es fluido)
+    bool falls = false;         // cae si debajo no hay nada que lo sostenga (arena, nieve)
+    float blastResistance = 1.0f; // fuerza que necesita una explosión para romperlo; < 0 = no se rompe
+};
+
+// Nivel de un tile de fluido lleno; los parciales van de 1 a FLUID_MAX - 1 (Chunk::fluid)
+const int FLUID_MAX = 8;
+
+// Con la herramienta adecuada el tiempo de picado se multiplica por esto
+const float TOOL_SPEEDUP = 0.45f;
+
+namespace detail {
+constexpr void def_block(std::array<BlockTraits, BLOCK_COUNT> &t, BlockId id, Rgb color, float hardness, Tool tool, const char *name, std::uint8_t light = 0) {
+    BlockTraits &b = t[id];
+    b.color = color;
+    b.hardness = hardness;
+    b.tool = tool;
+    b.light = light;
+    b.drop = id;
+    b.name = name;
+}
+
+constexpr std::array<BlockTraits, BLOCK_COUNT> make_block_table() {
+    std::array<BlockTraits, BLOCK_COUNT> t{};
+    def_block(t, AIR, {135, 206, 235}, -1.0f, TOOL_NONE, "Aire");
+    t[AIR].solid = false;
+    t[AIR].drop = AIR;
+    def_block(t, GRASS, {88, 166, 72}, 1.0f, TOOL_NONE, "Hierba");
+    def_block(t, DIRT, {134, 96, 67}, 1.0f, TOOL_SHOVEL, "Tierra");
+    def_block(t, STONE, {120, 120, 120}, 2.0f, TOOL_PICKAXE, "Piedra");
+    def_block(t, WOOD, {150, 111, 51}, 0.8f, TOOL_AXE, "Madera");
+    def_block(t, BEDR, {40, 40, 40}, -1.0f, TOOL_NONE, "Bedrock");
+    t[BEDR].drop = AIR;
+    def_block(t, LEAF, {110, 180, 80}, 0.4f, TOOL_AXE, "Hoja");
+    def_block(t, COAL, {30, 30, 30}, 1.2f, TOOL_PICKAXE, "Carbón");
+    def_block(t, IRON, {180, 180, 200}, 3.0f, TOOL_PICKAXE, "Hierro");
+    def_block(t, GOLD, {212, 175, 55}, 4.0f, TOOL_PICKAXE, "Oro");
+    def_block(t, SAND, {194, 178, 128}, 1.0f, TOOL_SHOVEL, "Arena");
+    def_block(t, SNOW, {235, 245, 255}, 1.0f, TOOL_NONE, "Nieve");
+    def_block(t, NETH, {120, 30, 30}, 1.0f, TOOL_NONE, "Neth");
+    def_block(t, LAVA, {255, 120, 20}, 1.0f, TOOL_NONE, "Lava", 15);
+    def_block(t, WATER, {50, 100, 220}, 1.0f, TOOL_NONE, "Agua");
+    // fluidos: no bloquean el paso; la lava avanza mucho más despacio que el agua
+    t[LAVA].solid = false;
+    t[LAVA].flowPeriod = 6;
+    t[WATER].solid = false;
+    t[WATER].flowPeriod = 1;
+    t[SAND].falls = true;
+    t[SNOW].falls = true;
+    // resistencia a explosiones: la tierra y la arena saltan lejos, la piedra y los minerales cerca
+    t[GRASS].blastResistance = 0.5f;
+    t[DIRT].blastResistance = 0.5f;
+    t[STONE].blastResistance = 1.5f;
+    t[BEDR].blastResistance = -1.0f;
+    t[LEAF].blastResistance = 0.2f;
+    t[COAL].blastResistance = 1.5f;
+    t[IRON].blastResistance = 2.0f;
+    t[GOLD].blastResistance = 2.0f;
+    t[SAND].blastResistance = 0.5f;
+    t[SNOW].blastResistance = 0.2f;
+    t[NETH].blastResistance = 0.4f;
+    t[LAVA].blastResistance = -1.0f;
+    t[WATER].blastResistance = -1.0f;
+    return t;
+}
+} // namespace detail
+
+inline constexpr std::array<BlockTraits, BLOCK_COUNT> BLOCK_TRAITS = detail::make_block_table();
+
+// `b` debe ser un id válido (< BLOCK_COUNT): las partidas cargadas se validan al leerlas
+inline const BlockTraits &block_traits(BlockId b) { return BLOCK_TRAITS[b]; }
+
+inline bool is_fluid(BlockId b) { return BLOCK_TRAITS[b].flowPeriod != 0; }
+
+// Multiplicador del tiempo de picado de `b` sosteniendo `held` (< 0 = no se puede picar)
+inline float break_time_multiplier(BlockId b, Tool held) {
+    const BlockTraits &t = block_traits(b);
+    return (held != TOOL_NONE && t.tool == held) ? t.hardness * TOOL_SPEEDUP : t.hardness;
+}
+
+static_assert(!BLOCK_TRAITS[AIR].solid, "el aire no es sólido");
+static_assert(BLOCK_TRAITS[STONE].tool == TOOL_PICKAXE, "la piedra se pica con pico");
+static_assert(!BLOCK_TRAITS[LAVA].solid && !BLOCK_TRAITS[WATER].solid, "los fluidos no son sólidos");
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#include "BlockTraits.hpp"
+#include "Lighting.hpp"
+#include "TextureAtlas.hpp"
+#include "World.hpp"
+
+inline sf::Color block_color(BlockId b) {
+    const Rgb &c = block_traits(b).color;
+    return sf::Color(c.r, c.g, c.b);
+}
+
+// Render de tiles por chunk: cada chunk visible se convierte una sola vez en un
+// sf::VertexArray de quads (saltando el aire) y se dibuja con una llamada.
+// La malla solo se reconstruye si el chunk cambió (Chunk::revision, que también
+// avanza cuando cambia su luz) o si el nivel de luz ambiental cuantizado es
+// distinto al usado al construirla. Cada tile se tiñe con su luz (Chunk::light)
+// y los fluidos a medio nivel solo ocupan la parte de abajo de su tile.
+// Los chunks que aún no se generaron se dibujan como un rectángulo liso (placeholder).
+class ChunkRenderer {
+public:
+    static const int AMBIENT_LEVELS = 32;
+
+    // Bloques con textura propia: `blockRegions[b]` es la región del atlas para el bloque b (o -1 = color sólido)
+    void set_atlas(const TextureAtlas *a, const std::array<int, BLOCK_COUNT> &blockRegions) {
+        atlas = a;
+        regions = blockRegions;
+        meshes.clear();
+    }
+
+    // Dibuja todos los chunks que tocan el rectángulo visible (coordenadas del mundo en píxeles)
+    void draw(sf::RenderTarget &target, const World &world, const sf::FloatRect &view, float ambient) {
+        int level = (int)std::lround(std::max(0.0f, std::min(1.0f, ambient)) * AMBIENT_LEVELS);
+        const float chunkPx = (float)(CHUNK * TILE);
+        int minCx = (int)std::floor(view.left / chunkPx);
+        int minCy = (int)std::floor(view.top / chunkPx);
+        int maxCx = (int)std::floor((view.left + view.width) / chunkPx);
+        int maxCy = (int)std::floor((view.top + view.height) / chunkPx);
+        frame++;
+        drawCalls = 0;
+        placeholders.clear();
+        for (int cy = minCy; cy <= maxCy; ++cy) {
+            for (int cx = minCx; cx <= maxCx; ++cx) {
+                const Chunk *c = world.find_chunk(cx, cy);
+                if (!c) {
+                    if (!world.is_generated(cx, cy)) add_placeholder(world, cx, cy, level);
+                    continue; // chunk vacío (todo aire): se ve el cielo
+                }
+                Mesh &m = meshes[World::key(cx, cy)];
+                if (m.revision != c->revision || m.ambientLevel != level) build(m, *c, cx, cy, level);
+                m.lastFrame = frame;
+                if (m.vertices.getVertexCount() == 0) continue;
+                if (atlas) target.draw(m.vertices, sf::RenderStates(&atlas->getTexture()));
+                else target.draw(m.vertices);
+                drawCalls++;
+            }
+        }
+        if (placeholders.getVertexCount() > 0) {
+            if (atlas) target.draw(placeholders, sf::RenderStates(&atlas->getTexture()));
+            else target.draw(placeholders);
+            drawCalls++;
+        }
+        evict();
+    }
+
+    // Llamadas de dibujo del último draw(): una por chunk con tiles más una para los placeholders
+    int draw_calls() const { return drawCalls; }
+
+private:
+    struct Mesh {
+        sf::VertexArray vertices{sf::Quads};
+        std::uint64_t revision = 0;
+        int ambientLevel = -1;
+        std::uint64_t lastFrame = 0;
+    };
+
+    void build(Mesh &m, const Chunk &c, int cx, int cy, int level) {
+        // color base por bloque (los texturizados usan blanco para no teñir la textura)
+        // y brillo en 1/256 para cada valor de luz empaquetada con este ambiente:
+        // por tile solo queda un producto entero
+        std::array<sf::Color, BLOCK_COUNT> base;
+        std::array<sf::IntRect, BLOCK_COUNT> uv;
+        std::array<unsigned, 256> bright;
+        float amb = (float)level / AMBIENT_LEVELS;
+        for (int i = 0; i < BLOCK_COUNT; ++i) {
+            bool textured = atlas && regions[i] >= 0;
+            base[i] = textured ? sf::Color::White : block_color((BlockId)i);
+            if (atlas) uv[i] = atlas->region(textured ? regions[i] : TextureAtlas::WHITE);
+        }
+        for (int l = 0; l < 256; ++l) bright[l] = (unsigned)std::lround(256.0f * light_brightness((std::uint8_t)l, amb));
+        m.vertices.clear();
+        float ox = (float)(cx * CHUNK * TILE), oy = (float)(cy * CHUNK * TILE);
+        for (int ly = 0; ly < CHUNK; ++ly) {
+            for (int lx = 0; lx < CHUNK; ++lx) {
+                BlockId b = c.at(lx, ly);
+                if (b == AIR) continue;
+                unsigned k = bright[c.light[ly * CHUNK + lx]];
+                const sf::Color &bc = base[b];
+                sf::Color col((sf::Uint8)((bc.r * k) >> 8), (sf::Uint8)((bc.g * k) >> 8), (sf::Uint8)((bc.b * k) >> 8));
+                const sf::IntRect &r = uv[b];
+                float x0 = ox + lx * TILE, y0 = oy + ly * TILE;
+                float x1 = x0 + TILE, y1 = y0 + TILE;
+                float u0 = (float)r.left, v0 = (float)r.top, u1 = u0 + r.width, v1 = v0 + r.height;
+                if (std::uint8_t level = c.fluid[ly * CHUNK + lx]) {
+                    // fluido a medio nivel: solo la parte de abajo del tile
+                    float empty = (float)(FLUID_MAX - level) / FLUID_MAX;
+                    y0 += TILE * empty;
+                    v0 += r.height * empty;
+                }
+                m.vertices.append(sf::Vertex(sf::Vector2f(x0, y0), col, sf::Vector2f(u0, v0)));
+                m.vertices.append(sf::Vertex(sf::Vector2f(x1, y0), col, sf::Vector2f(u1, v0)));
+                m.vertices.append(sf::Vertex(sf::Vector2f(x1, y1), col, sf::Vector2f(u1, v1)));
+                m.vertices.append(sf::Vertex(sf::Vector2f(x0, y1), col, sf::Vector2f(u0, v1)));
+            }
+        }
+        m.revision = c.revision;
+        m.ambientLevel = level;
+    }
+
+    // Rectángulo del chunk sin generar, recortado a los límites del mundo
+    void add_placeholder(const World &world, int cx, int cy, int level) {
+        int x0 = cx * CHUNK, y0 = cy * CHUNK;
+        int x1 = std::min(world.width(), x0 + CHUNK), y1 = std::min(world.height(), y0 + CHUNK);
+        if (x0 < 0 || y0 < 0 || x0 >= x1 || y0 >= y1) return;
+        float amb = (float)level / AMBIENT_LEVELS;
+        sf::Color col((sf::Uint8)(placeholderColor.r * amb), (sf::Uint8)(placeholderColor.g * amb), (sf::Uint8)(placeholderColor.b * amb));
+        sf::IntRect r = atlas ? atlas->region(TextureAtlas::WHITE) : sf::IntRect();
+        float u0 = (float)r.left, v0 = (float)r.top, u1 = u0 + r.width, v1 = v0 + r.height;
+        float px0 = (float)(x0 * TILE), py0 = (float)(y0 * TILE), px1 = (float)(x1 * TILE), py1 = (float)(y1 * TILE);
+        placeholders.append(sf::Vertex(sf::Vector2f(px0, py0), col, sf::Vector2f(u0, v0)));
+        placeholders.append(sf::Vertex(sf::Vector2f(px1, py0), col, sf::Vector2f(u1, v0)));
+        placeholders.append(sf::Vertex(sf::Vector2f(px1, py1), col, sf::Vector2f(u1, v1)));
+        placeholders.append(sf::Vertex(sf::Vector2f(px0, py1), col, sf::Vector2f(u0, v1)));
+    }
+
+    // Libera mallas de chunks que llevan tiempo fuera de la vista
+    void evict() {
+        if (meshes.size() < 64) return;
+        for (auto it = meshes.begin(); it != meshes.end();) {
+            if (frame - it->second.lastFrame > 300) it = meshes.erase(it);
+            else ++it;
+        }
+    }
+
+    const TextureAtlas *atlas = nullptr;
+    std::array<int, BLOCK_COUNT> regions;
+    std::unordered_map<std::uint64_t, Mesh> meshes;
+    sf::VertexArray placeholders{sf::Quads};
+    sf::Color placeholderColor = sf::Color(70, 70, 80);
+    std::uint64_t frame = 0;
+    int drawCalls = 0;
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "World.hpp"
+#include "WorldGen.hpp"
+
+// Cola sin bloqueos de varios productores y un consumidor (MPSC de Vyukov).
+// push() se puede llamar desde cualquier hilo; pop() solo desde uno.
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node()), tail(head.load()) {}
+    ~MpscQueue() {
+        T tmp;
+        while (pop(tmp)) {}
+        delete tail;
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    void push(T value) {
+        Node *n = new Node();
+        n->value = std::move(value);
+        Node *prev = head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    bool pop(T &out) {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        delete tail;
+        tail = next; // `next` pasa a ser el nodo centinela
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+    std::atomic<Node *> head; // último nodo (productores)
+    Node *tail;               // centinela (consumidor)
+};
+
+// Generación de chunks en segundo plano. El hilo principal pide cada frame los
+// chunks que faltan alrededor de la cámara (los más cercanos primero); los hilos
+// de trabajo los generan con WorldGen y devuelven el resultado por una cola sin
+// bloqueos que el hilo principal vacía con collect(). Solo el hilo principal toca
+// el World, así que la simulación y el render nunca esperan a la generación.
+class ChunkStreamer {
+public:
+    ChunkStreamer(const WorldGen &generator, int threads) : gen(generator) {
+        for (int i = 0; i < std::max(1, threads); ++i) workers.emplace_back([this] { work(); });
+    }
+
+    ~ChunkStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    ChunkStreamer(const ChunkStreamer &) = delete;
+    ChunkStreamer &operator=(const ChunkStreamer &) = delete;
+
+    // Pide los chunks sin generar a `radius` chunks de (px, py) (píxeles del mundo).
+    // Reemplaza los pedidos anteriores que aún no empezaron, así que la prioridad
+    // sigue al jugador y lo que quedó lejos deja de generarse.
+    void request_around(const World &world, float px, float py, int radius) {
+        // retirar los pedidos que ningún worker tomó todavía; se vuelven a ordenar abajo
+        std::vector<Request> stale;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stale.swap(queue);
+        }
+        for (auto &r : stale) requested.erase(World::key(r.cx, r.cy));
+
+        const float chunkPx = (float)(CHUNK * TILE);
+        int ccx = (int)std::floor(px / chunkPx), ccy = (int)std::floor(py / chunkPx);
+        int maxCx = (world.width() + CHUNK - 1) / CHUNK, maxCy = (world.height() + CHUNK - 1) / CHUNK;
+        std::vector<Request> wanted;
+        for (int cy = std::max(0, ccy - radius); cy <= std::min(maxCy - 1, ccy + radius); ++cy) {
+            for (int cx = std::max(0, ccx - radius); cx <= std::min(maxCx - 1, ccx + radius); ++cx) {
+                if (world.is_generated(cx, cy) || requested.count(World::key(cx, cy))) continue;
+                float dx = (cx + 0.5f) * chunkPx - px, dy = (cy + 0.5f) * chunkPx - py;
+                wanted.push_back(Request{cx, cy, dx * dx + dy * dy});
+            }
+        }
+        if (wanted.empty()) return;
+        // los workers toman del final: el más cercano va último
+        std::sort(wanted.begin(), wanted.end(), [](const Request &a, const Request &b) { return a.dist2 > b.dist2; });
+        for (auto &r : wanted) requested.insert(World::key(r.cx, r.cy));
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.swap(wanted);
+        }
+        cv.notify_all();
+    }
+
+    // Entrega al mundo los chunks terminados; nunca bloquea. Devuelve cuántos llegaron.
+    int collect(World &world) {
+        Result r;
+        int n = 0;
+        while (done.pop(r)) {
+            requested.erase(World::key(r.cx, r.cy));
+            n++;
+            if (world.is_generated(r.cx, r.cy)) continue;
+            if (r.chunk) world.insert_chunk(r.cx, r.cy, std::move(r.chunk));
+            else world.mark_generated(r.cx, r.cy);
+        }
+        return n;
+    }
+
+    // Chunks pedidos o en generación (solo hilo principal)
+    std::size_t pending() const { return requested.size(); }
+
+private:
+    struct Request { int cx, cy; float dist2; };
+    struct Result { int cx = 0, cy = 0; std::unique_ptr<Chunk> chunk; };
+
+    void work() {
+        for (;;) {
+            Request r;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) return;
+                r = queue.back();
+                queue.pop_back();
+            }
+            std::unique_ptr<Chunk> c(new Chunk());
+            Result res;
+            res.cx = r.cx; res.cy = r.cy;
+            if (gen.generate_chunk(r.cx, r.cy, *c)) res.chunk = std::move(c);
+            done.push(std::move(res));
+        }
+    }
+
+    const WorldGen gen;
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::vector<Request> queue; // protegido por mtx
+    MpscQueue<Result> done;
+    std::unordered_set<std::uint64_t> requested; // en cola o en generación (solo hilo principal)
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "World.hpp"
+
+// Colisión de cajas (AABB) contra los tiles sólidos, común a jugador y enemigos
+// (y a cualquier cuerpo con x, y, vx, vy, w, h). El movimiento va primero en x y
+// luego en y; en cada eje se recorren todas las columnas / filas de tiles que
+// cruza el borde delantero de la caja y se para en la primera con algún sólido,
+// así que un paso largo (caída a MAX_FALL_SPEED con un frame lento) ya no
+// atraviesa el suelo. Si no hay nada entre medias el resultado es el mismo que
+// mirando solo el tile de destino.
+namespace collision {
+
+struct Contacts {
+    bool hitX = false;     // se paró contra una pared
+    bool hitY = false;     // se paró contra el suelo o el techo
+    bool grounded = false; // después de moverse tiene suelo justo debajo
+};
+
+// Consultas de solidez con el último chunk en cache: las de un cuerpo (y las de
+// cuerpos cercanos seguidos) casi siempre caen en el mismo chunk y se ahorran la
+// búsqueda en el hash map. Lo que cae fuera del mundo no cuenta como sólido; un
+// chunk todo aire no tiene sólidos y uno sin generar cuenta según World::unloaded_mask().
+// Solo lectura: cada hilo usa la suya.
+class SolidProbe {
+public:
+    explicit SolidProbe(const World &w) : world(w) {}
+
+    // ¿Algún sólido en la columna x, filas [y0, y1]?
+    bool any_in_col(int x, int y0, int y1) {
+        if (x < 0 || x >= world.width()) return false;
+        y0 = std::max(y0, 0); y1 = std::min(y1, world.height() - 1);
+        for (int y = y0; y <= y1; y = (y | (CHUNK - 1)) + 1) {
+            int hi = std::min(y1, y | (CHUNK - 1));
+            const Chunk *c = chunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+            std::uint64_t m = c ? c->solidCols[x & (CHUNK - 1)] : fill;
+            if (m & bit_range(y & (CHUNK - 1), hi & (CHUNK - 1))) return true;
+        }
+        return false;
+    }
+
+    // ¿Algún sólido en la fila y, columnas [x0, x1]?
+    bool any_in_row(int x0, int x1, int y) {
+        if (y < 0 || y >= world.height()) return false;
+        x0 = std::max(x0, 0); x1 = std::min(x1, world.width() - 1);
+        for (int x = x0; x <= x1; x = (x | (CHUNK - 1)) + 1) {
+            int hi = std::min(x1, x | (CHUNK - 1));
+            const Chunk *c = chunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+            std::uint64_t m = c ? c->solidRows[y & (CHUNK - 1)] : fill;
+            if (m & bit_range(x & (CHUNK - 1), hi & (CHUNK - 1))) return true;
+        }
+        return false;
+    }
+
+private:
+    // Chunk (cx, cy) o nullptr; en ese caso `fill` es la máscara con la que cuenta
+    const Chunk *chunk(int cx, int cy) {
+        std::uint64_t k = World::key(cx, cy);
+        if (k == cachedKey && valid) return cached;
+        cachedKey = k;
+        valid = true;
+        cached = world.find_chunk(cx, cy);
+        if (!cached) fill = world.is_generated(cx, cy) ? 0ull : world.unloaded_mask();
+        return cached;
+    }
+
+    const World &world;
+    std::uint64_t cachedKey = 0;
+    bool valid = false;
+    const Chunk *cached = nullptr;
+    std::uint64_t fill = 0;
+};
+
+// Tile que contiene la coordenada v (en píxeles): floor(v / TILE) sin llamar a
+// std::floor (TILE es potencia de 2, así que multiplicar por 1/TILE es exacto)
+inline int tile_of(float v) {
+    float t = v * (1.0f / TILE);
+    int i = (int)t;
+    return i - (t < (float)i);
+}
+
+// ¿Hay un sólido en la fila de tiles justo debajo de la caja (a 1 px)?
+inline bool grounded(SolidProbe &probe, float x, float y, float w, float h) {
+    return probe.any_in_row(tile_of(x), tile_of(x + w - 1), tile_of(y + h + 1));
+}
+
+// Mueve la caja (x, y, w, h) con velocidad (vx, vy) durante dt. Al chocar en un
+// eje la caja queda pegada al tile y esa velocidad pasa a 0. No rellena `grounded`.
+inline Contacts sweep_aabb(SolidProbe &probe, float &x, float &y, float &vx, float &vy, float w, float h, float dt) {
+    Contacts out;
+    // eje x: columnas que cruza el borde delantero, filas que ocupa ahora
+    float newX = x + vx * dt;
+    int top = tile_of(y), bottom = tile_of(y + h - 1);
+    if (vx > 0) {
+        int from = tile_of(x + w - 1), to = tile_of(newX + w - 1);
+        for (int c = to > from ? from + 1 : to; c <= to; ++c)
+            if (probe.any_in_col(c, top, bottom)) { newX = c * TILE - w; vx = 0; out.hitX = true; break; }
+    } else if (vx < 0) {
+        int from = tile_of(x), to = tile_of(newX);
+        for (int c = to < from ? from - 1 : to; c >= to; --c)
+            if (probe.any_in_col(c, top, bottom)) { newX = (c + 1) * TILE; vx = 0; out.hitX = true; break; }
+    }
+    x = newX;
+    // eje y: filas que cruza, columnas que ocupa después de moverse en x
+    float newY = y + vy * dt;
+    int left = tile_of(x), right = tile_of(x + w - 1);
+    if (vy > 0) { // falling
+        int from = tile_of(y + h - 1), to = tile_of(newY + h - 1);
+        for (int r = to > from ? from + 1 : to; r <= to; ++r)
+            if (probe.any_in_row(left, right, r)) { newY = r * TILE - h; vy = 0; out.hitY = true; break; }
+    } else if (vy < 0) { // rising
+        int from = tile_of(y), to = tile_of(newY);
+        for (int r = to < from ? from - 1 : to; r >= to; --r)
+            if (probe.any_in_row(left, right, r)) { newY = (r + 1) * TILE; vy = 0; out.hitY = true; break; }
+    }
+    y = newY;
+    return out;
+}
+
+// sweep_aabb() más el estado de suelo al terminar
+inline Contacts move_aabb(SolidProbe &probe, float &x, float &y, float &vx, float &vy, float w, float h, float dt) {
+    Contacts out = sweep_aabb(probe, x, y, vx, vy, w, h, dt);
+    out.grounded = grounded(probe, x, y, w, h);
+    return out;
+}
+
+// Los cuerpos [begin, end) de un almacén en estructura de arrays (vectores x, y,
+// vx, vy, w, h; p.ej. EnemyArchetype); `grounded[i - begin]` recibe el estado de
+// suelo de cada uno si no es nulo
+template <class Soa>
+void move_batch(SolidProbe &probe, Soa &s, std::uint32_t begin, std::uint32_t end, float dt, std::uint8_t *groundedOut = nullptr) {
+    float *x = s.x.data(), *y = s.y.data(), *vx = s.vx.data(), *vy = s.vy.data();
+    const float *w = s.w.data(), *h = s.h.data();
+    if (!groundedOut) {
+        for (std::uint32_t i = begin; i < end; ++i) sweep_aabb(probe, x[i], y[i], vx[i], vy[i], w[i], h[i], dt);
+        return;
+    }
+    for (std::uint32_t i = begin; i < end; ++i)
+        groundedOut[i - begin] = move_aabb(probe, x[i], y[i], vx[i], vy[i], w[i], h[i], dt).grounded;
+}
+
+} // namespace collision
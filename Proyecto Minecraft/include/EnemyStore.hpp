@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENEMY_SSE2 1
+#endif
+
+// Enemy simple con tipos: ZOMBIE, SKELETON, SPIDER, CREEPER.
+// Es el registro completo de un enemigo para crearlo, guardarlo y cargarlo; en
+// el juego se almacenan en un EnemyStore (estructura de arrays).
+struct Enemy {
+    enum Type { ZOMBIE=0, SKELETON=1, SPIDER=2, CREEPER=3 } type;
+    float x, y;
+    float vx, vy;
+    float w, h;
+    int dir; // dirección horizontal preferida (-1 o 1)
+    float moveSpeed;
+    float pauseTimer; // tiempo de pausa para comportamiento torpe
+    // creeper-specific
+    float fuseTimer; // >0 means about to explode
+    bool alive;
+    int hp; // health points
+    int maxHp;
+    float respawnTimer; // seconds until respawn when dead
+    int spawnTileX, spawnTileY; // where to respawn (tile coords)
+    float prevX, prevY; // posición al inicio del último tick (para interpolar el render)
+};
+
+const int ENEMY_TYPE_COUNT = 4;
+
+// Los enemigos de un tipo (arquetipo), un array contiguo por campo. Los slots
+// están particionados: [0, active) son los vivos que se simulan este tick y
+// [active, active + dead) los muertos pendientes de respawn; el resto son vivos
+// lejos del jugador. Así los kernels recorren memoria contigua.
+struct EnemyArchetype {
+    // calientes: los tocan los kernels y la IA cada tick
+    std::vector<float> x, y, vx, vy, prevX, prevY, pauseTimer;
+    std::vector<std::uint8_t> paused; // pauseTimer > 0 al empezar el tick (lo escribe begin_tick)
+    // fríos
+    std::vector<float> w, h, moveSpeed, fuseTimer, respawnTimer;
+    std::vector<int> dir, hp, maxHp, spawnTileX, spawnTileY;
+    std::vector<std::uint8_t> alive;
+    std::vector<std::uint32_t> id; // id global del slot
+    std::vector<std::uint8_t> role; // auxiliar de EnemyStore::partition (0 fuera de ella)
+    std::uint32_t active = 0, dead = 0;
+
+    std::uint32_t size() const { return (std::uint32_t)id.size(); }
+};
+
+// Vista de un enemigo dentro del EnemyStore con los mismos nombres de campo que
+// Enemy; solo es válida hasta que el store reordene o añada slots.
+struct EnemyRef {
+    Enemy::Type type;
+    float &x, &y, &vx, &vy, &w, &h;
+    int &dir;
+    float &moveSpeed, &pauseTimer, &fuseTimer;
+    std::uint8_t &alive;
+    int &hp, &maxHp;
+    float &respawnTimer;
+    int &spawnTileX, &spawnTileY;
+    float &prevX, &prevY;
+};
+
+// Almacén de enemigos en estructura de arrays agrupado por tipo. Cada enemigo
+// tiene un id global estable (orden de creación; es el que usan la rejilla
+// espacial, las partidas guardadas y el orden de proceso) que se traduce a
+// (tipo, slot). Los slots se mueven al reparticionar, los ids no.
+class EnemyStore {
+public:
+    struct Loc { std::uint8_t type; std::uint32_t slot; };
+
+    std::uint32_t size() const { return (std::uint32_t)where.size(); }
+    const Loc &loc(std::uint32_t id) const { return where[id]; }
+    EnemyArchetype &archetype(int t) { return arch[t]; }
+    const EnemyArchetype &archetype(int t) const { return arch[t]; }
+
+    // Añade un enemigo y devuelve su id
+    std::uint32_t add(const Enemy &e) {
+        EnemyArchetype &a = arch[e.type];
+        std::uint32_t id = size();
+        where.push_back(Loc{(std::uint8_t)e.type, a.size()});
+        a.x.push_back(e.x); a.y.push_back(e.y); a.vx.push_back(e.vx); a.vy.push_back(e.vy);
+        a.prevX.push_back(e.prevX); a.prevY.push_back(e.prevY); a.pauseTimer.push_back(e.pauseTimer);
+        a.paused.push_back(0);
+        a.w.push_back(e.w); a.h.push_back(e.h); a.moveSpeed.push_back(e.moveSpeed);
+        a.fuseTimer.push_back(e.fuseTimer); a.respawnTimer.push_back(e.respawnTimer);
+        a.dir.push_back(e.dir); a.hp.push_back(e.hp); a.maxHp.push_back(e.maxHp);
+        a.spawnTileX.push_back(e.spawnTileX); a.spawnTileY.push_back(e.spawnTileY);
+        a.alive.push_back(e.alive ? 1 : 0);
+        a.id.push_back(id);
+        a.role.push_back(0);
+        return id;
+    }
+
+    // Copia del enemigo `id` (guardado)
+    Enemy get(std::uint32_t id) const {
+        const Loc &l = where[id];
+        const EnemyArchetype &a = arch[l.type];
+        std::uint32_t s = l.slot;
+        Enemy e{};
+        e.type = (Enemy::Type)l.type;
+        e.x = a.x[s]; e.y = a.y[s]; e.vx = a.vx[s]; e.vy = a.vy[s]; e.w = a.w[s]; e.h = a.h[s];
+        e.dir = a.dir[s]; e.moveSpeed = a.moveSpeed[s]; e.pauseTimer = a.pauseTimer[s]; e.fuseTimer = a.fuseTimer[s];
+        e.alive = a.alive[s] != 0; e.hp = a.hp[s]; e.maxHp = a.maxHp[s]; e.respawnTimer = a.respawnTimer[s];
+        e.spawnTileX = a.spawnTileX[s]; e.spawnTileY = a.spawnTileY[s];
+        e.prevX = a.prevX[s]; e.prevY = a.prevY[s];
+        return e;
+    }
+
+    EnemyRef ref(std::uint32_t id) { return slot_ref(where[id].type, where[id].slot); }
+
+    EnemyRef slot_ref(int t, std::uint32_t s) {
+        EnemyArchetype &a = arch[t];
+        return EnemyRef{(Enemy::Type)t, a.x[s], a.y[s], a.vx[s], a.vy[s], a.w[s], a.h[s], a.dir[s],
+                        a.moveSpeed[s], a.pauseTimer[s], a.fuseTimer[s], a.alive[s], a.hp[s], a.maxHp[s],
+                        a.respawnTimer[s], a.spawnTileX[s], a.spawnTileY[s], a.prevX[s], a.prevY[s]};
+    }
+
+    bool alive(std::uint32_t id) const { return arch[where[id].type].alive[where[id].slot] != 0; }
+
+    std::uint32_t alive_count() const {
+        std::uint32_t n = 0;
+        for (auto &a : arch) for (std::uint8_t v : a.alive) n += v;
+        return n;
+    }
+
+    // Reparticiona los slots: los de `activeIds` (vivos a simular) pasan a
+    // [0, active) y los de `deadIds` a [active, active + dead). Solo se mueven los
+    // que están fuera de su zona, así que si los conjuntos apenas cambian de un
+    // tick a otro casi no se mueve nada. El orden dentro de cada zona no importa.
+    void partition(const std::vector<std::uint32_t> &activeIds, const std::vector<std::uint32_t> &deadIds) {
+        for (auto &a : arch) { a.active = 0; a.dead = 0; }
+        for (std::uint32_t id : activeIds) { EnemyArchetype &a = arch[where[id].type]; a.role[where[id].slot] = ROLE_ACTIVE; a.active++; }
+        for (std::uint32_t id : deadIds) { EnemyArchetype &a = arch[where[id].type]; a.role[where[id].slot] = ROLE_DEAD; a.dead++; }
+        for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) {
+            EnemyArchetype &a = arch[t];
+            gather_into(t, 0, a.active, ROLE_ACTIVE, activeIds);
+            gather_into(t, a.active, a.active + a.dead, ROLE_DEAD, deadIds);
+            std::fill(a.role.begin(), a.role.begin() + (a.active + a.dead), ROLE_OTHER);
+        }
+    }
+
+private:
+    enum Role : std::uint8_t { ROLE_OTHER = 0, ROLE_ACTIVE, ROLE_DEAD };
+
+    // Mete en [lo, hi) los enemigos de `ids` del tipo t que están fuera, cada uno
+    // en un hueco (slot de la zona con otro rol). Hay tantos huecos como enemigos fuera.
+    void gather_into(int t, std::uint32_t lo, std::uint32_t hi, std::uint8_t role, const std::vector<std::uint32_t> &ids) {
+        EnemyArchetype &a = arch[t];
+        std::uint32_t hole = lo;
+        for (std::uint32_t id : ids) {
+            if (where[id].type != t) continue;
+            std::uint32_t s = where[id].slot;
+            if (s >= lo && s < hi) continue;
+            while (a.role[hole] == role) ++hole;
+            move_slot(a, s, hole++);
+        }
+    }
+
+    void move_slot(EnemyArchetype &a, std::uint32_t from, std::uint32_t to) {
+        if (from == to) return;
+        std::swap(a.x[from], a.x[to]); std::swap(a.y[from], a.y[to]);
+        std::swap(a.vx[from], a.vx[to]); std::swap(a.vy[from], a.vy[to]);
+        std::swap(a.prevX[from], a.prevX[to]); std::swap(a.prevY[from], a.prevY[to]);
+        std::swap(a.pauseTimer[from], a.pauseTimer[to]); std::swap(a.paused[from], a.paused[to]);
+        std::swap(a.w[from], a.w[to]); std::swap(a.h[from], a.h[to]);
+        std::swap(a.moveSpeed[from], a.moveSpeed[to]); std::swap(a.fuseTimer[from], a.fuseTimer[to]);
+        std::swap(a.respawnTimer[from], a.respawnTimer[to]);
+        std::swap(a.dir[from], a.dir[to]); std::swap(a.hp[from], a.hp[to]); std::swap(a.maxHp[from], a.maxHp[to]);
+        std::swap(a.spawnTileX[from], a.spawnTileX[to]); std::swap(a.spawnTileY[from], a.spawnTileY[to]);
+        std::swap(a.alive[from], a.alive[to]); std::swap(a.role[from], a.role[to]);
+        std::swap(a.id[from], a.id[to]);
+        where[a.id[from]].slot = from;
+        where[a.id[to]].slot = to;
+    }
+
+    EnemyArchetype arch[ENEMY_TYPE_COUNT];
+    std::vector<Loc> where; // id global -> (tipo, slot)
+};
+
+// Kernels por lotes sobre los slots de un arquetipo. Con SSE2 procesan 4 enemigos
+// por instrucción; la ruta escalar hace las mismas operaciones en el mismo orden,
+// así que el resultado es idéntico bit a bit.
+namespace enemy_kernels {
+
+// Vivos activos [0, active): guarda la posición anterior, descuenta la pausa
+// (y anula vx) de los que estaban en pausa, anotándolo en `paused`, y aplica la
+// gravedad con la velocidad de caída limitada a `maxFall`
+inline void begin_tick(EnemyArchetype &a, float dt, float gravityDt, float maxFall) {
+    std::uint32_t n = a.active, i = 0;
+    float *x = a.x.data(), *y = a.y.data(), *vx = a.vx.data(), *vy = a.vy.data();
+    float *px = a.prevX.data(), *py = a.prevY.data(), *pause = a.pauseTimer.data();
+    std::uint8_t *paused = a.paused.data();
+#ifdef ENEMY_SSE2
+    const __m128 vdt = _mm_set1_ps(dt), vg = _mm_set1_ps(gravityDt), vmax = _mm_set1_ps(maxFall), zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(px + i, _mm_loadu_ps(x + i));
+        _mm_storeu_ps(py + i, _mm_loadu_ps(y + i));
+        __m128 p = _mm_loadu_ps(pause + i);
+        __m128 m = _mm_cmpgt_ps(p, zero);
+        _mm_storeu_ps(pause + i, _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(p, vdt)), _mm_andnot_ps(m, p)));
+        _mm_storeu_ps(vx + i, _mm_andnot_ps(m, _mm_loadu_ps(vx + i)));
+        int bits = _mm_movemask_ps(m);
+        for (int k = 0; k < 4; ++k) paused[i + k] = (std::uint8_t)((bits >> k) & 1);
+        _mm_storeu_ps(vy + i, _mm_min_ps(_mm_add_ps(_mm_loadu_ps(vy + i), vg), vmax));
+    }
+#endif
+    for (; i < n; ++i) {
+        px[i] = x[i]; py[i] = y[i];
+        paused[i] = pause[i] > 0.0f;
+        if (paused[i]) { pause[i] -= dt; vx[i] = 0.0f; }
+        vy[i] = std::min(vy[i] + gravityDt, maxFall);
+    }
+}
+
+// Muertos [active, active + dead): posición anterior y cuenta atrás del respawn (sin bajar de 0)
+inline void dead_tick(EnemyArchetype &a, float dt) {
+    std::uint32_t i = a.active, n = a.active + a.dead;
+    float *x = a.x.data(), *y = a.y.data(), *px = a.prevX.data(), *py = a.prevY.data(), *rt = a.respawnTimer.data();
+#ifdef ENEMY_SSE2
+    const __m128 vdt = _mm_set1_ps(dt), zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(px + i, _mm_loadu_ps(x + i));
+        _mm_storeu_ps(py + i, _mm_loadu_ps(y + i));
+        __m128 t = _mm_loadu_ps(rt + i);
+        __m128 m = _mm_cmpgt_ps(t, zero);
+        _mm_storeu_ps(rt + i, _mm_or_ps(_mm_and_ps(m, _mm_max_ps(zero, _mm_sub_ps(t, vdt))), _mm_andnot_ps(m, t)));
+    }
+#endif
+    for (; i < n; ++i) {
+        px[i] = x[i]; py[i] = y[i];
+        if (rt[i] > 0.0f) rt[i] = std::max(0.0f, rt[i] - dt);
+    }
+}
+
+} // namespace enemy_kernels
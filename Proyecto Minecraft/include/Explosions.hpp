@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "BlockTraits.hpp"
+#include "World.hpp"
+
+// Huella de las explosiones en el mundo. La fuerza de una explosión baja
+// linealmente de `power` en su centro a 0 en el borde de su círculo; un tile se
+// rompe si la suma de las fuerzas que le llegan supera BlockTraits::blastResistance
+// de su bloque: con la misma carga la tierra salta más lejos que la piedra, el
+// bedrock y los fluidos no se rompen, y varios creepers juntos abren un hueco más
+// grande que uno solo. Todas las explosiones de un tick se calculan juntas y se
+// aplican con un solo World::set_batch.
+namespace explosion {
+
+struct Blast {
+    float x, y;    // centro (px)
+    float radius;  // px
+    float power;   // fuerza en el centro (en unidades de blastResistance)
+};
+
+// Tiles que rompen `blasts` (sin repetir) como ediciones a aire en `out`, con el
+// bloque que había en `broken` (mismo orden); para aplicar con World::set_batch
+inline void footprint(const World &world, const std::vector<Blast> &blasts, std::vector<TileEdit> &out, std::vector<BlockId> &broken) {
+    struct Hit { int x, y; float strength; };
+    std::vector<Hit> hits;
+    out.clear();
+    broken.clear();
+    for (const Blast &b : blasts) {
+        int x0 = std::max(0, (int)std::floor((b.x - b.radius) / TILE));
+        int y0 = std::max(0, (int)std::floor((b.y - b.radius) / TILE));
+        int x1 = std::min(world.width() - 1, (int)std::floor((b.x + b.radius) / TILE));
+        int y1 = std::min(world.height() - 1, (int)std::floor((b.y + b.radius) / TILE));
+        for (int y = y0; y <= y1; ++y) {
+            float dy = (y + 0.5f) * TILE - b.y;
+            for (int x = x0; x <= x1; ++x) {
+                float dx = (x + 0.5f) * TILE - b.x;
+                float d = std::sqrt(dx * dx + dy * dy);
+                if (d < b.radius) hits.push_back(Hit{x, y, b.power * (1.0f - d / b.radius)});
+            }
+        }
+    }
+    // suma por tile (en orden (y, x); stable_sort: la suma no depende de la implementación)
+    std::stable_sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+    for (std::size_t i = 0; i < hits.size();) {
+        float strength = 0.0f;
+        std::size_t j = i;
+        for (; j < hits.size() && hits[j].x == hits[i].x && hits[j].y == hits[i].y; ++j) strength += hits[j].strength;
+        BlockId id = world.get(hits[i].x, hits[i].y);
+        float resistance = block_traits(id).blastResistance;
+        if (id != AIR && resistance >= 0.0f && strength > resistance) {
+            out.push_back(TileEdit{hits[i].x, hits[i].y, AIR});
+            broken.push_back(id);
+        }
+        i = j;
+    }
+}
+
+} // namespace explosion
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "BlockTraits.hpp"
+#include "World.hpp"
+
+// Campo de flujo hacia un tile objetivo (el del jugador) en una ventana de
+// tiles a su alrededor, compartido por todos los enemigos: cada uno mira la
+// celda de sus pies y obtiene hacia dónde andar y si tiene que saltar, sin
+// buscar caminos por su cuenta.
+//
+// Los nodos son las celdas de aire con un sólido debajo (donde se puede estar
+// de pie). Las aristas siguen las reglas de un plataformas:
+//  - andar a la celda de al lado si también es de pie;
+//  - saltar a la columna de al lado hasta JUMP_TILES más arriba si hay hueco encima;
+//  - bajar: salir a una columna con aire debajo y caer hasta el suelo.
+// Se hace un BFS hacia atrás desde el objetivo (cada paso cuesta 1), así que
+// `dist` es el número de movimientos hasta el jugador. Las celdas de aire sin
+// suelo copian lo de la celda donde aterrizarían: quien cae o está saltando
+// sigue la misma ruta.
+//
+// update() solo recalcula cuando cambia la celda de pie del objetivo (saltar no
+// cuenta) o cuando el mundo cambió (World::edit_count) dentro de la ventana; el
+// resultado depende únicamente de los bloques de la ventana y del objetivo, así
+// que es determinista.
+class FlowField {
+public:
+    static const int JUMP_TILES = 2;         // altura de salto de un enemigo (~90 px)
+    static constexpr std::uint16_t UNREACHABLE = 0xFFFF;
+
+    // Recalcula si hace falta para el objetivo (tx, ty) y una ventana de `radius`
+    // tiles alrededor. Devuelve true si lo recalculó.
+    bool update(const World &world, int tx, int ty, int radius) {
+        // el objetivo es la celda donde aterriza: mientras salta no cambia
+        int ground = world.first_solid_in_col(tx, ty, ty + radius);
+        if (ground > ty) ty = ground - 1;
+        bool sameTarget = valid && tx == targetX && ty == targetY && radius == r;
+        if (sameTarget && world.edit_count() == seenEdits) return false;
+        seenEdits = world.edit_count();
+        if (sameTarget) {
+            // cambió algo en el mundo: solo hay que rehacerlo si fue dentro de la ventana
+            copy_window(world, scratch);
+            if (scratch == solid) return false;
+            solid.swap(scratch);
+        } else {
+            valid = true;
+            targetX = tx; targetY = ty; r = radius;
+            n = 2 * r + 1;
+            ox = targetX - r; oy = targetY - r;
+            copy_window(world, solid);
+        }
+        compute();
+        return true;
+    }
+
+    // Dirección (-1, 0, 1) y salto para quien tiene los pies en (x, y); false si
+    // está fuera de la ventana o no hay camino. dir 0 = ya está en el objetivo.
+    bool sample(int x, int y, int &dir, bool &jump) const {
+        int i = index(x, y);
+        if (i < 0 || dist[i] == UNREACHABLE) return false;
+        dir = (step[i] & RIGHT_BIT) ? 1 : (step[i] & LEFT_BIT) ? -1 : 0;
+        jump = (step[i] & JUMP_BIT) != 0;
+        return true;
+    }
+
+    // Movimientos hasta el objetivo desde (x, y) (UNREACHABLE si no hay camino)
+    std::uint16_t distance(int x, int y) const {
+        int i = index(x, y);
+        return i < 0 ? UNREACHABLE : dist[i];
+    }
+
+private:
+    enum : std::uint8_t { RIGHT_BIT = 0x1, LEFT_BIT = 0x2, JUMP_BIT = 0x4 };
+
+    int index(int x, int y) const {
+        if (!valid) return -1;
+        int lx = x - ox, ly = y - oy;
+        if (lx < 0 || ly < 0 || lx >= n || ly >= n) return -1;
+        return ly * n + lx;
+    }
+
+    bool air(int lx, int ly) const { return lx >= 0 && ly >= 0 && lx < n && ly < n && !solid[ly * n + lx]; }
+    // de pie: aire con sólido debajo (el borde inferior de la ventana no cuenta como suelo)
+    bool standing(int lx, int ly) const { return air(lx, ly) && ly + 1 < n && solid[(ly + 1) * n + lx]; }
+
+    void reach(int lx, int ly, std::uint16_t d, std::uint8_t s) {
+        int i = ly * n + lx;
+        if (dist[i] != UNREACHABLE) return;
+        dist[i] = d;
+        step[i] = s;
+        open.push_back(i);
+    }
+
+    // Copia local de la solidez de la ventana; fuera del mundo cuenta como pared
+    void copy_window(const World &world, std::vector<std::uint8_t> &out) const {
+        out.assign((std::size_t)n * n, 1);
+        int x0 = std::max(ox, 0), x1 = std::min(ox + n, world.width()) - 1;
+        for (int ly = 0; ly < n; ++ly) {
+            int y = oy + ly;
+            if (y < 0 || y >= world.height()) continue;
+            for (int x = x0; x <= x1;) {
+                const BlockId *t = world.row_span(x, y);
+                int end = std::min(x1, x | (CHUNK - 1));
+                for (int i = 0; x + i <= end; ++i) out[ly * n + (x + i - ox)] = block_traits(t[i]).solid;
+                x = end + 1;
+            }
+        }
+    }
+
+    void compute() {
+        std::size_t cells = (std::size_t)n * n;
+        dist.assign(cells, UNREACHABLE);
+        step.assign(cells, 0);
+        // objetivo: la celda de pie en la que acabaría el jugador
+        int gx = r, gy = r;
+        while (gy < n && air(gx, gy) && !standing(gx, gy)) ++gy;
+        if (!standing(gx, gy)) return; // dentro de un bloque o sin suelo en la ventana
+        open.clear();
+        reach(gx, gy, 0, 0);
+        // BFS hacia atrás: para cada nodo v, los nodos u con una arista u -> v
+        for (std::size_t head = 0; head < open.size(); ++head) {
+            int v = open[head];
+            int vx = v % n, vy = v / n;
+            std::uint16_t d = (std::uint16_t)(dist[v] + 1);
+            for (int s = -1; s <= 1; s += 2) {
+                int ux = vx + s;
+                std::uint8_t toward = s < 0 ? RIGHT_BIT : LEFT_BIT; // u se mueve hacia v
+                // andar
+                if (standing(ux, vy)) reach(ux, vy, d, toward);
+                // saltar desde abajo: hueco en la columna de u desde su cabeza hasta la fila de v
+                for (int k = 1; k <= JUMP_TILES && air(ux, vy + k - 1); ++k)
+                    if (standing(ux, vy + k)) reach(ux, vy + k, d, toward | JUMP_BIT);
+            }
+            // bajar: desde cualquier celda de pie junto a la columna de aire que cae sobre v
+            for (int ry = vy - 1; air(vx, ry); --ry) {
+                if (standing(vx - 1, ry)) reach(vx - 1, ry, d, RIGHT_BIT);
+                if (standing(vx + 1, ry)) reach(vx + 1, ry, d, LEFT_BIT);
+            }
+        }
+        // celdas en el aire: lo mismo que donde aterrizan
+        for (int lx = 0; lx < n; ++lx) {
+            for (int ly = n - 2; ly >= 0; --ly) {
+                int i = ly * n + lx, below = i + n;
+                if (solid[i] || solid[below]) continue;
+                dist[i] = dist[below];
+                step[i] = step[below];
+            }
+        }
+    }
+
+    bool valid = false;
+    int targetX = 0, targetY = 0, r = 0;
+    std::uint64_t seenEdits = 0;
+    int n = 0, ox = 0, oy = 0; // ventana: n x n tiles desde (ox, oy)
+    std::vector<std::uint8_t> solid, step, scratch;
+    std::vector<std::uint16_t> dist;
+    std::vector<int> open; // cola del BFS (cada celda entra una vez)
+};
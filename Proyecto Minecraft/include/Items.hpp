@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Bits.hpp"
+#include "BlockTraits.hpp"
+
+// Objetos del inventario con ids densos: primero todos los bloques (el id de un
+// bloque es su id de objeto) y detrás las herramientas. El inventario es un array
+// de contadores indexado por id, sin mapas ni cadenas en el tick; los nombres de
+// TOOL_INFO solo se usan al guardar y cargar.
+//
+// Recetas de fabricación: cada una tiene su firma, la máscara de bits de los
+// objetos que gasta, y RECIPES_USING[objeto] indexa las recetas cuya firma lo
+// contiene. Al cambiar un contador el inventario solo revisa esas recetas, así
+// que saber qué se puede fabricar (Inventory::craftable) es leer una máscara.
+
+typedef std::uint8_t ItemId;
+
+enum Item : ItemId {
+    ITEM_PICKAXE = BLOCK_COUNT, ITEM_AXE, ITEM_SHOVEL, ITEM_SWORD,
+    ITEM_COUNT
+};
+
+static_assert(ITEM_COUNT <= 32, "la firma de una receta es una máscara de 32 bits");
+
+// Objeto de una herramienta (t != TOOL_NONE)
+inline constexpr ItemId tool_item(Tool t) { return (ItemId)(ITEM_PICKAXE + (t - TOOL_PICKAXE)); }
+
+inline const char *item_name(ItemId i) {
+    return i < BLOCK_COUNT ? block_traits(i).name : TOOL_INFO[TOOL_PICKAXE + (i - ITEM_PICKAXE)].name;
+}
+
+const int MAX_INGREDIENTS = 3;
+
+struct Ingredient {
+    ItemId item = AIR;
+    std::uint8_t count = 0; // 0 = hueco libre
+};
+
+struct Recipe {
+    ItemId output = AIR;
+    std::uint8_t outputCount = 1;
+    std::array<Ingredient, MAX_INGREDIENTS> in{};
+
+    constexpr std::uint32_t signature() const {
+        std::uint32_t s = 0;
+        for (const Ingredient &g : in) if (g.count) s |= 1u << g.item;
+        return s;
+    }
+};
+
+// Añadir recetas siempre al final: el índice es el que llega en TickInput::craft
+inline constexpr std::array<Recipe, 8> RECIPES = {{
+    {ITEM_PICKAXE, 1, {{{WOOD, 2}, {STONE, 3}}}},
+    {ITEM_AXE, 1, {{{WOOD, 2}, {STONE, 2}}}},
+    {ITEM_SHOVEL, 1, {{{WOOD, 2}, {STONE, 1}}}},
+    {ITEM_SWORD, 1, {{{WOOD, 1}, {IRON, 2}}}},
+    {GRASS, 1, {{{DIRT, 1}, {LEAF, 1}}}},
+    {WOOD, 1, {{{LEAF, 4}}}},
+    {STONE, 2, {{{SAND, 2}, {COAL, 1}}}},
+    {WATER, 1, {{{SNOW, 2}}}},
+}};
+
+const int RECIPE_COUNT = (int)RECIPES.size();
+static_assert(RECIPES.size() <= 32, "Inventory::craftable es una máscara de 32 bits");
+
+namespace detail {
+constexpr std::array<std::uint32_t, ITEM_COUNT> make_recipe_index() {
+    std::array<std::uint32_t, ITEM_COUNT> t{};
+    for (int r = 0; r < (int)RECIPES.size(); ++r)
+        for (int i = 0; i < (int)ITEM_COUNT; ++i)
+            if (RECIPES[r].signature() & (1u << i)) t[i] |= 1u << r;
+    return t;
+}
+} // namespace detail
+
+// Recetas (máscara de índices en RECIPES) que gastan cada objeto
+inline constexpr std::array<std::uint32_t, ITEM_COUNT> RECIPES_USING = detail::make_recipe_index();
+
+class Inventory {
+public:
+    int count(ItemId i) const { return counts[i]; }
+    bool has(ItemId i, int n = 1) const { return counts[i] >= n; }
+
+    void set(ItemId i, int n) {
+        counts[i] = n;
+        changed(i);
+    }
+    void add(ItemId i, int n = 1) { set(i, counts[i] + n); }
+    // Gasta n unidades si las hay
+    bool take(ItemId i, int n = 1) {
+        if (counts[i] < n) return false;
+        set(i, counts[i] - n);
+        return true;
+    }
+
+    // Recetas que se pueden fabricar ahora (bit r = RECIPES[r])
+    std::uint32_t craftable() const { return craftableMask; }
+    bool can_craft(int r) const { return r >= 0 && r < RECIPE_COUNT && (craftableMask >> r) & 1u; }
+
+    // Gasta los ingredientes de la receta r y añade su resultado; false si no hay suficientes
+    bool craft(int r) {
+        if (!can_craft(r)) return false;
+        const Recipe &rec = RECIPES[r];
+        for (const Ingredient &g : rec.in) if (g.count) set(g.item, counts[g.item] - g.count);
+        add(rec.output, rec.outputCount);
+        return true;
+    }
+
+private:
+    // Vuelve a mirar solo las recetas que gastan el objeto i
+    void changed(ItemId i) {
+        if (counts[i] > 0) present |= 1u << i;
+        else present &= ~(1u << i);
+        for (std::uint32_t m = RECIPES_USING[i]; m; m &= m - 1) {
+            int r = lowest_bit(m);
+            const Recipe &rec = RECIPES[r];
+            bool ok = (rec.signature() & ~present) == 0; // están todos los ingredientes
+            for (const Ingredient &g : rec.in) ok = ok && counts[g.item] >= g.count;
+            if (ok) craftableMask |= 1u << r;
+            else craftableMask &= ~(1u << r);
+        }
+    }
+
+    std::array<int, ITEM_COUNT> counts{};
+    std::uint32_t present = 0;       // objetos con contador > 0
+    std::uint32_t craftableMask = 0;
+};
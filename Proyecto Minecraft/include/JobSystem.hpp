@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo para bucles paralelos de la simulación.
+// parallel_for() parte [0, n) en trozos y los reparte entre las colas de todos
+// los hilos (el que llama también trabaja, con el índice 0). Cada hilo saca de
+// su propia cola por el final y, cuando se queda sin trabajo, roba del principio
+// de la cola de otro, así que un trozo lento no deja a los demás parados.
+//
+// El índice de hilo que recibe el cuerpo sirve para escribir en buffers propios
+// de cada hilo sin sincronización. Qué hilo procesa cada trozo no es
+// determinista: quien necesite un resultado reproducible debe ordenar lo que
+// junte de esos buffers (ver update_enemies).
+class JobSystem {
+public:
+    // `threads`: hilos de trabajo además del que llama (0 = todo en el que llama)
+    explicit JobSystem(int threads) {
+        int n = std::max(0, threads) + 1;
+        for (int i = 0; i < n; ++i) queues.emplace_back(new Queue());
+        for (int i = 1; i < n; ++i) workers.emplace_back([this, i] { run(i); });
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // Hilos que pueden ejecutar trabajo (incluido el que llama): tamaño de los buffers por hilo
+    int thread_count() const { return (int)queues.size(); }
+
+    // fn(begin, end, thread) para trozos de como mucho `grain` elementos que cubren
+    // [0, n); vuelve cuando terminaron todos. Solo desde un hilo a la vez y sin anidar.
+    template <class Fn>
+    void parallel_for(std::uint32_t n, std::uint32_t grain, Fn fn) {
+        if (n == 0) return;
+        grain = std::max<std::uint32_t>(1, grain);
+        std::uint32_t chunks = (n + grain - 1) / grain;
+        if (queues.size() == 1 || chunks == 1) { fn(0u, n, 0); return; }
+        Body body = [&fn](std::uint32_t b, std::uint32_t e, int t) { fn(b, e, t); };
+        job = &body;
+        remaining.store(chunks, std::memory_order_relaxed);
+        // trozos contiguos para cada cola: al principio cada hilo recorre memoria seguida
+        std::uint32_t perQueue = (chunks + (std::uint32_t)queues.size() - 1) / (std::uint32_t)queues.size();
+        for (std::uint32_t c = 0; c < chunks; ++c)
+            queues[c / perQueue]->push(Range{c * grain, std::min(n, (c + 1) * grain)});
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            generation++;
+        }
+        cv.notify_all();
+        work_until_done(0);
+        job = nullptr;
+    }
+
+private:
+    typedef std::function<void(std::uint32_t, std::uint32_t, int)> Body;
+    struct Range { std::uint32_t begin, end; };
+
+    struct Queue {
+        std::mutex m;
+        std::deque<Range> items;
+
+        void push(Range r) {
+            std::lock_guard<std::mutex> lock(m);
+            items.push_back(r);
+        }
+        bool pop_back(Range &r) {
+            std::lock_guard<std::mutex> lock(m);
+            if (items.empty()) return false;
+            r = items.back();
+            items.pop_back();
+            return true;
+        }
+        bool steal_front(Range &r) {
+            std::lock_guard<std::mutex> lock(m);
+            if (items.empty()) return false;
+            r = items.front();
+            items.pop_front();
+            return true;
+        }
+    };
+
+    void run(int self) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work_until_done(self);
+        }
+    }
+
+    // Ejecuta trozos (propios o robados) hasta que no quede ninguno sin terminar
+    void work_until_done(int self) {
+        const int n = (int)queues.size();
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            Range r;
+            bool got = queues[self]->pop_back(r);
+            for (int k = 1; k < n && !got; ++k) got = queues[(self + k) % n]->steal_front(r);
+            if (!got) { std::this_thread::yield(); continue; }
+            (*job)(r.begin, r.end, self);
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues; // una por hilo; la 0 es la del que llama
+    std::vector<std::thread> workers;
+    const Body *job = nullptr; // cuerpo del parallel_for en curso (se publica con las colas)
+    std::atomic<std::uint32_t> remaining{0}; // trozos sin terminar
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::uint64_t generation = 0; // protegido por mtx; cambia con cada parallel_for
+    bool stopping = false;
+};
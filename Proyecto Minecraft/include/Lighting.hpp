@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "BlockTraits.hpp"
+#include "World.hpp"
+
+// Luz por tile con dos canales de 0 a MAX_LIGHT:
+//  - cielo: MAX_LIGHT en todo lo que está por encima del primer bloque sólido de su columna;
+//  - bloques: lo que emite cada bloque (BlockTraits::light, p.ej. la lava).
+// Desde esas fuentes la luz se expande por inundación (BFS por niveles) perdiendo
+// 1 por tile al salir de uno no sólido (o de un emisor) y SOLID_FALLOFF al salir
+// de uno sólido, así que las paredes de una cueva se ven pero la roca se oscurece.
+//
+// Como ningún tile recibe luz de algo a más de MAX_LIGHT pasos, basta recalcular
+// la zona cambiada con un margen de MAX_LIGHT tiles: se copia zona + margen a
+// buffers locales, se siembran las fuentes, se inunda y se escribe de vuelta solo
+// la zona (el resultado es exacto, no una aproximación). update() procesa lo que
+// el mundo anotó con take_light_dirty(): picar un bloque recalcula unos 60x60 tiles.
+//
+// Al crear o cargar una partida no se inunda el mapa entero (en un mundo de 10M
+// tiles eso son cientos de ms): reset() solo calcula la altura del cielo por
+// columna y deja los chunks como pendientes, y light_view() ilumina cada uno la
+// primera vez que se acerca a la cámara. La luz solo se usa para dibujar, así
+// que la simulación no depende de qué chunks se hayan iluminado ya.
+class LightEngine {
+public:
+    static const int SOLID_FALLOFF = 4;
+    static const int BLOCK_SIZE = 256; // lado máximo de la zona que se procesa de una vez
+
+    // Empieza de cero con el mundo (al crear o cargar una partida): todos sus
+    // chunks quedan pendientes hasta que light_view() los alcance
+    void reset(World &world) {
+        world.take_light_dirty();
+        skyTop.assign(world.width(), 0);
+        for (int x = 0; x < world.width(); ++x) skyTop[x] = compute_sky_top(world, x);
+        unlit.clear();
+        world.for_each_generated([&](int cx, int cy, const Chunk *c) { if (c) unlit.insert(World::key(cx, cy)); });
+    }
+
+    // Ilumina los chunks pendientes que tocan `view` (en tiles). Devuelve cuántos.
+    std::size_t light_view(World &world, TileRect view) {
+        if (unlit.empty() || !clip(world, view)) return 0;
+        std::size_t n = 0;
+        for (int cy = view.y0 >> CHUNK_SHIFT; cy <= view.y1 >> CHUNK_SHIFT; ++cy) {
+            for (int cx = view.x0 >> CHUNK_SHIFT; cx <= view.x1 >> CHUNK_SHIFT; ++cx) {
+                if (!unlit.erase(World::key(cx, cy))) continue;
+                TileRect r{cx * CHUNK, cy * CHUNK, cx * CHUNK + CHUNK - 1, cy * CHUNK + CHUNK - 1};
+                if (clip(world, r)) relight(world, r);
+                n++;
+            }
+        }
+        return n;
+    }
+
+    // Recalcula la luz alrededor de lo que cambió desde la última llamada.
+    // Devuelve los tiles reescritos (0 si no había nada pendiente).
+    std::size_t update(World &world) {
+        std::vector<TileRect> pending = world.take_light_dirty();
+        if (pending.empty()) return 0;
+        if ((int)skyTop.size() != world.width()) { reset(world); return 0; }
+        zones.clear();
+        for (TileRect r : pending) {
+            if (!clip(world, r)) continue;
+            // si cambia el primer sólido de una columna, cambian las fuentes de cielo entre la altura vieja y la nueva
+            for (int x = r.x0; x <= r.x1; ++x) {
+                int top = compute_sky_top(world, x);
+                if (top == skyTop[x]) continue;
+                r.y0 = std::min(r.y0, std::min(top, skyTop[x]));
+                r.y1 = std::max(r.y1, std::max(top, skyTop[x]));
+                skyTop[x] = top;
+            }
+            add_zone(TileRect{r.x0 - MAX_LIGHT, r.y0 - MAX_LIGHT, r.x1 + MAX_LIGHT, r.y1 + MAX_LIGHT});
+        }
+        std::size_t tiles = 0;
+        for (TileRect z : zones) {
+            if (!clip(world, z)) continue;
+            relight(world, z);
+            tiles += (std::size_t)(z.x1 - z.x0 + 1) * (z.y1 - z.y0 + 1);
+        }
+        return tiles;
+    }
+
+private:
+    static int compute_sky_top(const World &world, int x) {
+        int y = world.first_solid_in_col(x, 0, world.height() - 1);
+        return y < 0 ? world.height() : y;
+    }
+
+    static bool clip(const World &world, TileRect &r) {
+        r.x0 = std::max(r.x0, 0); r.y0 = std::max(r.y0, 0);
+        r.x1 = std::min(r.x1, world.width() - 1); r.y1 = std::min(r.y1, world.height() - 1);
+        return r.x0 <= r.x1 && r.y0 <= r.y1;
+    }
+
+    // Une `r` con las zonas que solapa (una explosión son muchos tiles contiguos: una sola zona)
+    void add_zone(TileRect r) {
+        for (std::size_t i = 0; i < zones.size();) {
+            const TileRect &z = zones[i];
+            if (z.x0 <= r.x1 && r.x0 <= z.x1 && z.y0 <= r.y1 && r.y0 <= z.y1) {
+                r = TileRect{std::min(r.x0, z.x0), std::min(r.y0, z.y0), std::max(r.x1, z.x1), std::max(r.y1, z.y1)};
+                zones[i] = zones.back();
+                zones.pop_back();
+                i = 0; // la zona creció: puede solapar alguna ya revisada
+            } else {
+                ++i;
+            }
+        }
+        zones.push_back(r);
+    }
+
+    void relight(World &world, const TileRect &r) {
+        for (int y = r.y0; y <= r.y1; y += BLOCK_SIZE)
+            for (int x = r.x0; x <= r.x1; x += BLOCK_SIZE)
+                relight_block(world, TileRect{x, y, std::min(r.x1, x + BLOCK_SIZE - 1), std::min(r.y1, y + BLOCK_SIZE - 1)});
+    }
+
+    void relight_block(World &world, const TileRect &r) {
+        TileRect h{r.x0 - MAX_LIGHT, r.y0 - MAX_LIGHT, r.x1 + MAX_LIGHT, r.y1 + MAX_LIGHT};
+        clip(world, h);
+        bw = h.x1 - h.x0 + 1;
+        bh = h.y1 - h.y0 + 1;
+        std::size_t n = (std::size_t)bw * bh;
+        falloff.resize(n); sky.resize(n); blk.resize(n);
+        // copia local de zona + margen: caída por tile y fuentes de los dos canales
+        for (int y = h.y0; y <= h.y1; ++y) {
+            std::size_t row = (std::size_t)(y - h.y0) * bw;
+            for (int x = h.x0; x <= h.x1;) {
+                const BlockId *t = world.row_span(x, y);
+                int end = std::min(h.x1, x | (CHUNK - 1));
+                for (int i = 0; x + i <= end; ++i) {
+                    const BlockTraits &bt = block_traits(t[i]);
+                    std::size_t k = row + (x + i - h.x0);
+                    falloff[k] = (std::uint8_t)(bt.solid && bt.light == 0 ? SOLID_FALLOFF : 1);
+                    sky[k] = (std::uint8_t)(y < skyTop[x + i] ? MAX_LIGHT : 0);
+                    blk[k] = bt.light;
+                }
+                x = end + 1;
+            }
+        }
+        flood(sky);
+        flood(blk);
+        // escribe solo la zona pedida; el margen solo aportaba fuentes
+        for (int y = r.y0; y <= r.y1; ++y) {
+            std::size_t row = (std::size_t)(y - h.y0) * bw;
+            for (int x = r.x0; x <= r.x1;) {
+                int end = std::min(r.x1, x | (CHUNK - 1));
+                int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, ly = y & (CHUNK - 1);
+                // se compara por la vista de solo lectura: find_chunk() copiaría un chunk compartido con el autoguardado
+                const Chunk *old = static_cast<const World &>(world).find_chunk(cx, cy);
+                bool changed = false;
+                for (int xx = x; old && xx <= end && !changed; ++xx) {
+                    std::size_t k = row + (xx - h.x0);
+                    changed = old->light[ly * CHUNK + (xx & (CHUNK - 1))] != pack_light(sky[k], blk[k]);
+                }
+                if (changed) {
+                    Chunk &c = *world.find_chunk(cx, cy);
+                    for (int xx = x; xx <= end; ++xx) {
+                        std::size_t k = row + (xx - h.x0);
+                        c.light[ly * CHUNK + (xx & (CHUNK - 1))] = pack_light(sky[k], blk[k]);
+                    }
+                    world.mark_relit(c);
+                }
+                x = end + 1;
+            }
+        }
+    }
+
+    // Inundación por niveles: cada tile se expande una sola vez, desde su nivel final
+    void flood(std::vector<std::uint8_t> &level) {
+        for (auto &b : buckets) b.clear();
+        for (std::size_t k = 0; k < level.size(); ++k)
+            if (level[k] > 1) buckets[level[k]].push_back((std::uint32_t)k);
+        for (int l = MAX_LIGHT; l > 1; --l) {
+            // spread() solo añade a niveles menores: el cubo actual no crece mientras se recorre
+            for (std::uint32_t k : buckets[l]) {
+                if (level[k] != l) continue; // llegó más luz después de encolarlo
+                int next = l - falloff[k];
+                if (next <= 0) continue;
+                int x = (int)(k % bw), y = (int)(k / bw);
+                if (x > 0) spread(level, k - 1, next);
+                if (x + 1 < bw) spread(level, k + 1, next);
+                if (y > 0) spread(level, k - bw, next);
+                if (y + 1 < bh) spread(level, k + bw, next);
+            }
+        }
+    }
+
+    void spread(std::vector<std::uint8_t> &level, std::uint32_t k, int v) {
+        if (level[k] >= v) return;
+        level[k] = (std::uint8_t)v;
+        if (v > 1) buckets[v].push_back(k);
+    }
+
+    std::vector<int> skyTop; // primer sólido de cada columna (height() si no hay)
+    std::unordered_set<std::uint64_t> unlit; // chunks (World::key) aún sin iluminar
+    std::vector<TileRect> zones;
+    // buffers de relight_block (se reutilizan)
+    int bw = 0, bh = 0;
+    std::vector<std::uint8_t> falloff, sky, blk;
+    std::array<std::vector<std::uint32_t>, MAX_LIGHT + 1> buckets;
+};
+
+// Brillo (0..1) de un tile con luz empaquetada `packed` cuando la luz del cielo vale `ambient`
+inline float light_brightness(std::uint8_t packed, float ambient) {
+    const float MIN_BRIGHTNESS = 0.08f; // las cuevas no quedan del todo negras
+    float sky = (float)(packed >> 4) / MAX_LIGHT * ambient;
+    float block = (float)(packed & 15) / MAX_LIGHT;
+    return std::max(MIN_BRIGHTNESS, std::max(sky, block));
+}
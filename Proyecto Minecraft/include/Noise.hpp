@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NOISE_SSE2 1
+#endif
+
+// Ruido de valor fractal (fBm) en 1D y 2D para la generación del terreno.
+// Las funciones *_row evalúan una fila de muestras equiespaciadas en x, de 4 en 4
+// con SSE2 cuando está disponible (el resto y las plataformas sin SSE2 usan la
+// versión escalar). Ambas rutas hacen exactamente las mismas operaciones en el
+// mismo orden, así que el resultado es idéntico bit a bit: el mundo no cambia
+// según cuántas columnas se evalúen juntas ni en qué orden.
+// El rango de salida es aproximadamente [-1, 1].
+namespace noise {
+
+inline std::uint32_t hash2(std::uint32_t seed, std::int32_t x, std::int32_t y) {
+    std::uint32_t h = seed ^ ((std::uint32_t)x * 0x27D4EB2Du) ^ ((std::uint32_t)y * 0x165667B1u);
+    h ^= h >> 15; h *= 0x2C1B3C6Du;
+    h ^= h >> 12; h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return h;
+}
+
+// valor del vértice de la retícula en [-1, 1)
+inline float lattice(std::uint32_t seed, std::int32_t x, std::int32_t y) {
+    return (float)(std::int32_t)(hash2(seed, x, y) >> 8) * (1.0f / 8388608.0f) - 1.0f;
+}
+
+inline float value2(std::uint32_t seed, float x, float y) {
+    float xf = std::floor(x), yf = std::floor(y);
+    std::int32_t xi = (std::int32_t)xf, yi = (std::int32_t)yf;
+    float fx = x - xf, fy = y - yf;
+    float ux = fx * fx * (3.0f - 2.0f * fx);
+    float uy = fy * fy * (3.0f - 2.0f * fy);
+    float a = lattice(seed, xi, yi), b = lattice(seed, xi + 1, yi);
+    float c = lattice(seed, xi, yi + 1), d = lattice(seed, xi + 1, yi + 1);
+    float top = a + (b - a) * ux;
+    float bot = c + (d - c) * ux;
+    return top + (bot - top) * uy;
+}
+
+inline std::uint32_t octave_seed(std::uint32_t seed, int o) { return seed + (std::uint32_t)o * 0x9E3779B9u; }
+
+// fBm: cada octava dobla la frecuencia y reduce la amplitud a la mitad; normalizado por la amplitud total
+inline float fbm2(std::uint32_t seed, float x, float y, int octaves) {
+    float sum = 0.0f, amp = 1.0f, norm = 0.0f, freq = 1.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum += value2(octave_seed(seed, o), x * freq, y * freq) * amp;
+        norm += amp;
+        amp *= 0.5f; freq *= 2.0f;
+    }
+    return sum / norm;
+}
+
+inline float fbm1(std::uint32_t seed, float x, int octaves) { return fbm2(seed, x, 0.0f, octaves); }
+
+#ifdef NOISE_SSE2
+namespace detail {
+// multiplicación 32x32 -> 32 bits por carril (SSE2 no tiene _mm_mullo_epi32)
+inline __m128i mullo32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128 lattice4(__m128i seed, __m128i x, __m128i y) {
+    __m128i h = _mm_xor_si128(seed, _mm_xor_si128(mullo32(x, _mm_set1_epi32((int)0x27D4EB2Du)), mullo32(y, _mm_set1_epi32((int)0x165667B1u))));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15)); h = mullo32(h, _mm_set1_epi32((int)0x2C1B3C6Du));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12)); h = mullo32(h, _mm_set1_epi32((int)0x297A2D39u));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 8)), _mm_set1_ps(1.0f / 8388608.0f));
+    return _mm_sub_ps(v, _mm_set1_ps(1.0f));
+}
+
+// floor exacto para valores representables en int32
+inline __m128 floor4(__m128 x, __m128i &xi) {
+    __m128i t = _mm_cvttps_epi32(x);
+    __m128 tf = _mm_cvtepi32_ps(t);
+    __m128i fix = _mm_castps_si128(_mm_cmplt_ps(x, tf)); // -1 donde truncar redondeó hacia arriba
+    xi = _mm_add_epi32(t, fix);
+    return _mm_cvtepi32_ps(xi);
+}
+
+inline __m128 smooth4(__m128 f) {
+    return _mm_mul_ps(_mm_mul_ps(f, f), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), f)));
+}
+
+inline __m128 value4(std::uint32_t seed, __m128 x, float y) {
+    __m128i s = _mm_set1_epi32((int)seed);
+    __m128i xi;
+    __m128 xf = floor4(x, xi);
+    float yf = std::floor(y);
+    __m128i yi = _mm_set1_epi32((std::int32_t)yf);
+    __m128i yi1 = _mm_set1_epi32((std::int32_t)yf + 1);
+    __m128i xi1 = _mm_add_epi32(xi, _mm_set1_epi32(1));
+    __m128 ux = smooth4(_mm_sub_ps(x, xf));
+    float fy = y - yf;
+    __m128 uy = _mm_set1_ps(fy * fy * (3.0f - 2.0f * fy));
+    __m128 a = lattice4(s, xi, yi), b = lattice4(s, xi1, yi);
+    __m128 c = lattice4(s, xi, yi1), d = lattice4(s, xi1, yi1);
+    __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), ux));
+    __m128 bot = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), ux));
+    return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bot, top), uy));
+}
+} // namespace detail
+#endif
+
+// out[i] = fbm2(seed, (x0 + i*dx) * scaleX, y * scaleY, octaves) para i en [0, n)
+inline void fbm2_row(std::uint32_t seed, float x0, float dx, float scaleX, float y, float scaleY, int octaves, int n, float *out) {
+    int i = 0;
+#ifdef NOISE_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128 px = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(x0), _mm_mul_ps(_mm_set_ps((float)(i + 3), (float)(i + 2), (float)(i + 1), (float)i), _mm_set1_ps(dx))), _mm_set1_ps(scaleX));
+        float py = y * scaleY;
+        __m128 sum = _mm_setzero_ps();
+        float amp = 1.0f, norm = 0.0f, freq = 1.0f;
+        for (int o = 0; o < octaves; ++o) {
+            __m128 v = detail::value4(octave_seed(seed, o), _mm_mul_ps(px, _mm_set1_ps(freq)), py * freq);
+            sum = _mm_add_ps(sum, _mm_mul_ps(v, _mm_set1_ps(amp)));
+            norm += amp;
+            amp *= 0.5f; freq *= 2.0f;
+        }
+        _mm_storeu_ps(out + i, _mm_div_ps(sum, _mm_set1_ps(norm)));
+    }
+#endif
+    for (; i < n; ++i) out[i] = fbm2(seed, (x0 + (float)i * dx) * scaleX, y * scaleY, octaves);
+}
+
+inline void fbm1_row(std::uint32_t seed, float x0, float dx, float scale, int octaves, int n, float *out) {
+    fbm2_row(seed, x0, dx, scale, 0.0f, 0.0f, octaves, n, out);
+}
+
+} // namespace noise
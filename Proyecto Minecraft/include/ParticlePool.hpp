@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "TextureAtlas.hpp"
+
+// Partículas (clima, chispas, restos de explosiones) en un pool de capacidad
+// fija con un array por campo. Crear una partícula con el pool lleno no hace
+// nada (el presupuesto se respeta aunque llueva mucho o exploten muchos creepers)
+// y las que mueren se quitan intercambiándolas con la última, sin mover el resto.
+// El render las vuelca todas a un SpriteBatch y las dibuja con una sola llamada.
+class ParticlePool {
+public:
+    explicit ParticlePool(std::size_t capacity = 0) { set_capacity(capacity); }
+
+    // Cambia el presupuesto; si sobran partículas se descartan las más nuevas
+    void set_capacity(std::size_t n) {
+        cap = n;
+        if (count > cap) count = cap;
+        for (auto *v : {&x, &y, &vx, &vy, &life, &w, &h}) v->resize(cap);
+        col.resize(cap);
+    }
+
+    std::size_t capacity() const { return cap; }
+    std::size_t size() const { return count; }
+    void clear() { count = 0; }
+
+    // (x, y): esquina superior izquierda del quad de w x h. false si no cabe.
+    bool spawn(float px, float py, float pvx, float pvy, float plife, float pw, float ph, sf::Color c) {
+        if (count >= cap) return false;
+        std::size_t i = count++;
+        x[i] = px; y[i] = py; vx[i] = pvx; vy[i] = pvy; life[i] = plife; w[i] = pw; h[i] = ph; col[i] = c;
+        return true;
+    }
+
+    // Avanza dt con gravedad `gravity` (px/s^2) y quita las que agotaron su vida
+    // o bajaron de `killBelowY`
+    void update(float dt, float gravity, float killBelowY = std::numeric_limits<float>::infinity()) {
+        const std::size_t n = count;
+        float *px = x.data(), *py = y.data(), *pvx = vx.data(), *pvy = vy.data(), *pl = life.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            px[i] += pvx[i] * dt;
+            py[i] += pvy[i] * dt;
+            pvy[i] += gravity * dt;
+            pl[i] -= dt;
+        }
+        for (std::size_t i = 0; i < count;) {
+            if (life[i] <= 0.0f || y[i] > killBelowY) remove(i);
+            else ++i;
+        }
+    }
+
+    // Un quad por partícula con la región `uv` del atlas (normalmente WHITE, teñida
+    // con su color). Con `fade` el alfa baja durante el último segundo de vida.
+    void add_to(SpriteBatch &batch, const sf::IntRect &uv, bool fade) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            sf::Color c = col[i];
+            if (fade) c.a = (sf::Uint8)(c.a * std::min(1.0f, std::max(0.0f, life[i])));
+            batch.add(x[i], y[i], w[i], h[i], uv, c);
+        }
+    }
+
+private:
+    void remove(std::size_t i) {
+        std::size_t last = --count;
+        x[i] = x[last]; y[i] = y[last]; vx[i] = vx[last]; vy[i] = vy[last];
+        life[i] = life[last]; w[i] = w[last]; h[i] = h[last]; col[i] = col[last];
+    }
+
+    std::vector<float> x, y, vx, vy, life, w, h;
+    std::vector<sf::Color> col;
+    std::size_t count = 0, cap = 0;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Medición de tiempos por subsistema. Cada zona tiene un id fijo (índice) y un
+// nombre; ProfileScope mide el tiempo de un bloque y lo acumula en su zona.
+// Con un puntero nulo no mide nada, así que la simulación puede llamarlo siempre.
+//
+// Además de los totales guarda, por zona, lo que sumó en cada uno de los últimos
+// HISTORY frames (end_frame() cierra uno) para sacar mínimo, media y p99: un pico
+// aislado se ve en el p99 aunque la media no se mueva. Con enable_trace() cada
+// medición queda también en un buffer circular de eventos que write_chrome_trace()
+// vuelca en el formato JSON de chrome://tracing / Perfetto.
+// No es seguro entre hilos: las zonas se miden desde el hilo principal.
+class Profiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr int HISTORY = 240; // frames en la ventana móvil (~4 s a 60 fps)
+
+    struct Zone {
+        std::string name;
+        double totalMs = 0.0;
+        std::uint64_t calls = 0;
+        double frameMs = 0.0;         // lo que lleva el frame en curso
+        std::vector<float> history;   // ms por frame (circular, ver `cursor`)
+    };
+
+    struct Stats {
+        float minMs = 0.0f, avgMs = 0.0f, p99Ms = 0.0f;
+    };
+
+    explicit Profiler(const std::vector<std::string> &names) : epoch(Clock::now()) {
+        for (auto &n : names) { Zone z; z.name = n; z.history.assign(HISTORY, 0.0f); zones.push_back(z); }
+    }
+
+    void add(int zone, double ms) {
+        zones[zone].totalMs += ms;
+        zones[zone].calls++;
+        zones[zone].frameMs += ms;
+        frameTouched = true;
+    }
+
+    // Una medición de [start, end): la suma y, si hay traza, la anota
+    void record(int zone, Clock::time_point start, Clock::time_point end) {
+        add(zone, std::chrono::duration<double, std::milli>(end - start).count());
+        if (trace.empty()) return;
+        TraceEvent &e = trace[traceNext];
+        e.zone = zone;
+        e.startUs = std::chrono::duration<double, std::micro>(start - epoch).count();
+        e.durUs = std::chrono::duration<double, std::micro>(end - start).count();
+        traceNext = (traceNext + 1) % trace.size();
+        traceCount = std::min(traceCount + 1, trace.size());
+    }
+
+    // Cierra el frame: lo de cada zona pasa a su historial (un frame sin mediciones no cuenta)
+    void end_frame() {
+        if (!frameTouched) return;
+        for (auto &z : zones) { z.history[cursor] = (float)z.frameMs; z.frameMs = 0.0; }
+        cursor = (cursor + 1) % HISTORY;
+        frames = std::min(frames + 1, HISTORY);
+        frameTouched = false;
+    }
+
+    // Mínimo, media y p99 de la zona en los últimos frames cerrados
+    Stats frame_stats(int zone) const {
+        Stats s;
+        if (frames == 0) return s;
+        const std::vector<float> &h = zones[zone].history;
+        scratch.assign(h.begin(), h.begin() + frames); // antes de llenarse, los primeros `frames`
+        double sum = 0.0;
+        for (float v : scratch) sum += v;
+        s.avgMs = (float)(sum / frames);
+        s.minMs = *std::min_element(scratch.begin(), scratch.end());
+        std::size_t k = std::min(scratch.size() - 1, (std::size_t)(0.99 * frames));
+        std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+        s.p99Ms = scratch[k];
+        return s;
+    }
+
+    void reset() {
+        for (auto &z : zones) { z.totalMs = 0.0; z.calls = 0; }
+    }
+
+    // Guarda las últimas `capacity` mediciones para write_chrome_trace (0 = sin traza)
+    void enable_trace(std::size_t capacity) {
+        trace.assign(capacity, TraceEvent());
+        traceNext = traceCount = 0;
+    }
+    bool tracing() const { return !trace.empty(); }
+
+    // Vuelca las mediciones guardadas como eventos completos ("ph":"X") en microsegundos
+    bool write_chrome_trace(const std::string &path) const {
+        std::FILE *f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+        std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+        std::size_t first = (traceNext + trace.size() - traceCount) % std::max<std::size_t>(1, trace.size());
+        for (std::size_t i = 0; i < traceCount; ++i) {
+            const TraceEvent &e = trace[(first + i) % trace.size()];
+            std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                         zones[e.zone].name.c_str(), e.startUs, e.durUs);
+        }
+        std::fprintf(f, "\n]}\n");
+        return std::fclose(f) == 0;
+    }
+
+    const std::vector<Zone> &get_zones() const { return zones; }
+
+private:
+    struct TraceEvent {
+        int zone = 0;
+        double startUs = 0.0, durUs = 0.0; // desde la creación del profiler
+    };
+
+    std::vector<Zone> zones;
+    Clock::time_point epoch;
+    int cursor = 0, frames = 0;
+    bool frameTouched = false;
+    std::vector<TraceEvent> trace; // circular: el siguiente se escribe en traceNext
+    std::size_t traceNext = 0, traceCount = 0;
+    mutable std::vector<float> scratch;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(Profiler *p, int zone) : prof(p), id(zone) {
+        if (prof) start = Profiler::Clock::now();
+    }
+    ~ProfileScope() {
+        if (prof) prof->record(id, start, Profiler::Clock::now());
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Profiler *prof;
+    int id;
+    Profiler::Clock::time_point start;
+};
+
+// Fases consecutivas de un bucle sin abrir un bloque por fase: next() cierra la
+// fase en curso y empieza la siguiente; stop() (o el destructor) cierra la última.
+class ProfilePhase {
+public:
+    explicit ProfilePhase(Profiler *p) : prof(p) {}
+    ~ProfilePhase() { stop(); }
+
+    void next(int zone) {
+        stop();
+        if (!prof) return;
+        current = zone;
+        start = Profiler::Clock::now();
+    }
+    void stop() {
+        if (prof && current >= 0) prof->record(current, start, Profiler::Clock::now());
+        current = -1;
+    }
+
+    ProfilePhase(const ProfilePhase &) = delete;
+    ProfilePhase &operator=(const ProfilePhase &) = delete;
+
+private:
+    Profiler *prof;
+    int current = -1;
+    Profiler::Clock::time_point start;
+};
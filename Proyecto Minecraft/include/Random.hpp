@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+// Números aleatorios deterministas. Todo sale de una semilla de 64 bits:
+// cada subsistema usa su propio flujo (RngStream), así que consumir números en
+// la IA no cambia el terreno, y una misma semilla da siempre el mismo mundo.
+// Para lo que depende de una posición (minerales, árboles) se usa coord_hash,
+// que no tiene estado y da el mismo valor sin importar el orden de generación.
+// Las semillas del ruido del terreno y de las cuevas las deriva WorldGen.
+
+// El valor de cada flujo entra en sus números: no renumerar (el 2 fue el de las cuevas)
+enum RngStream : std::uint64_t {
+    RNG_TERRAIN = 1, RNG_ORES = 3, RNG_TREES, RNG_AI, RNG_EFFECTS
+};
+
+// Mezclador de SplitMix64 (avanza `state` y devuelve 64 bits bien distribuidos)
+inline std::uint64_t splitmix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Hash sin estado de (semilla, flujo, x, y)
+inline std::uint64_t coord_hash(std::uint64_t seed, std::uint64_t stream, std::int64_t x, std::int64_t y) {
+    std::uint64_t s = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    splitmix64(s);
+    s ^= (std::uint64_t)x * 0x9E3779B97F4A7C15ull;
+    splitmix64(s);
+    s ^= (std::uint64_t)y * 0xC2B2AE3D27D4EB4Full;
+    return splitmix64(s);
+}
+
+// xoshiro256**: generador pequeño y rápido
+class Rng {
+public:
+    Rng() : Rng(0, 0) {}
+    Rng(std::uint64_t seed, std::uint64_t stream) {
+        std::uint64_t sm = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (auto &w : s) w = splitmix64(sm);
+    }
+
+    std::uint64_t next() {
+        std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Entero en [0, n) (0 si n <= 0)
+    int next_int(int n) { return n <= 0 ? 0 : (int)(next() % (std::uint64_t)n); }
+    // Real en [0, 1)
+    float next_float() { return (float)(next() >> 40) * (1.0f / 16777216.0f); }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    std::uint64_t s[4];
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+
+// Formato binario de guardado. Los valores se escriben en little-endian con
+// memcpy (las plataformas objetivo lo son); ByteReader comprueba los límites y
+// marca `ok = false` ante un archivo truncado o corrupto en vez de leer fuera.
+//
+// El mundo se guarda por chunks generados: coordenadas, tipo de codificación y
+// datos. Cada chunk usa RLE (valor + longitud en varint) o, si no comprime,
+// los 4096 bytes tal cual; cargar es memset/memcpy por tramo. Los chunks todo aire
+// solo ocupan la cabecera y los no generados no se guardan (se regeneran con la semilla).
+// Un id de bloque fuera de rango (>= BLOCK_COUNT) invalida el archivo.
+// Si el chunk tiene fluidos a medio nivel, la codificación lleva CHUNK_FLUID y
+// detrás de los tiles va la lista de esos tiles (índice, nivel); los llenos no
+// ocupan nada, así que los archivos sin fluidos parciales no cambian.
+
+class ByteWriter {
+public:
+    void u8(std::uint8_t v) { buf.push_back(v); }
+    void u16(std::uint16_t v) { raw(&v, 2); }
+    void u32(std::uint32_t v) { raw(&v, 4); }
+    void u64(std::uint64_t v) { raw(&v, 8); }
+    void i32(std::int32_t v) { raw(&v, 4); }
+    void f32(float v) { raw(&v, 4); }
+    void str(const std::string &s) { u32((std::uint32_t)s.size()); raw(s.data(), s.size()); }
+    void raw(const void *p, std::size_t n) {
+        const std::uint8_t *b = (const std::uint8_t *)p;
+        buf.insert(buf.end(), b, b + n);
+    }
+
+    std::vector<std::uint8_t> &data() { return buf; }
+
+    bool write_file(const std::string &path) const {
+        std::FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        return std::fclose(f) == 0 && ok;
+    }
+
+private:
+    std::vector<std::uint8_t> buf;
+};
+
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t *data, std::size_t size) : p(data), end(data + size) {}
+
+    std::uint8_t u8() { std::uint8_t v = 0; raw(&v, 1); return v; }
+    std::uint16_t u16() { std::uint16_t v = 0; raw(&v, 2); return v; }
+    std::uint32_t u32() { std::uint32_t v = 0; raw(&v, 4); return v; }
+    std::uint64_t u64() { std::uint64_t v = 0; raw(&v, 8); return v; }
+    std::int32_t i32() { std::int32_t v = 0; raw(&v, 4); return v; }
+    float f32() { float v = 0.0f; raw(&v, 4); return v; }
+    std::string str() {
+        std::uint32_t n = u32();
+        if (!ok || n > remaining()) { ok = false; return std::string(); }
+        std::string s((const char *)p, n);
+        p += n;
+        return s;
+    }
+    void raw(void *out, std::size_t n) {
+        if (!ok || n > remaining()) { ok = false; return; }
+        std::memcpy(out, p, n);
+        p += n;
+    }
+    const std::uint8_t *take(std::size_t n) {
+        if (!ok || n > remaining()) { ok = false; return nullptr; }
+        const std::uint8_t *r = p;
+        p += n;
+        return r;
+    }
+    std::size_t remaining() const { return (std::size_t)(end - p); }
+
+    bool ok = true;
+
+private:
+    const std::uint8_t *p;
+    const std::uint8_t *end;
+};
+
+inline bool read_file(const std::string &path, std::vector<std::uint8_t> &out) {
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size < 0) { std::fclose(f); return false; }
+    out.resize((std::size_t)size);
+    bool ok = std::fread(out.data(), 1, out.size(), f) == out.size();
+    std::fclose(f);
+    return ok;
+}
+
+namespace save {
+
+enum ChunkEncoding : std::uint8_t { CHUNK_EMPTY = 0, CHUNK_RLE = 1, CHUNK_RAW = 2, CHUNK_FLUID = 0x80 };
+
+// RLE de un chunk: (valor, longitud en varint: 1 byte hasta 127, 2 hasta 4096)*;
+// devuelve los bytes escritos en `out` (como mucho 3 por tile)
+inline std::size_t rle_encode(const Chunk &c, std::uint8_t *out) {
+    std::size_t n = 0;
+    const int total = CHUNK * CHUNK;
+    for (int i = 0; i < total;) {
+        BlockId v = c.tiles[i];
+        int j = i + 1;
+        while (j < total && c.tiles[j] == v) ++j;
+        unsigned len = (unsigned)(j - i);
+        out[n++] = v;
+        if (len < 0x80) out[n++] = (std::uint8_t)len;
+        else { out[n++] = (std::uint8_t)(0x80 | (len & 0x7F)); out[n++] = (std::uint8_t)(len >> 7); }
+        i = j;
+    }
+    return n;
+}
+
+inline bool rle_decode(const std::uint8_t *in, std::size_t size, Chunk &c) {
+    std::size_t pos = 0;
+    int i = 0;
+    const int total = CHUNK * CHUNK;
+    while (pos + 2 <= size) {
+        BlockId v = in[pos++];
+        unsigned len = in[pos++];
+        if (v >= BLOCK_COUNT) return false;
+        if (len & 0x80) {
+            if (pos >= size) return false;
+            len = (len & 0x7F) | ((unsigned)in[pos++] << 7);
+        }
+        if (len == 0 || i + (int)len > total) return false;
+        std::memset(c.tiles.data() + i, v, len);
+        i += (int)len;
+    }
+    return i == total && pos == size;
+}
+
+// Cabecera común a todos los archivos de partida
+const std::uint32_t MAGIC = 0x4432434D; // "MC2D"
+const std::uint32_t VERSION = 2; // 2: ids de bloque densos (BlockTraits.hpp)
+
+struct Header {
+    std::uint64_t seed = 0;
+    std::uint64_t tick = 0;
+};
+
+inline void write_header(ByteWriter &out, const Header &h) {
+    out.u32(MAGIC);
+    out.u32(VERSION);
+    out.u64(h.seed);
+    out.u64(h.tick);
+}
+
+inline bool read_header(ByteReader &in, Header &h) {
+    if (in.u32() != MAGIC) return false;
+    if (in.u32() != VERSION || !in.ok) return false;
+    h.seed = in.u64();
+    h.tick = in.u64();
+    return in.ok;
+}
+
+// Un chunk: coordenadas, codificación y datos (nullptr = generado y todo aire)
+inline void write_chunk(ByteWriter &out, int cx, int cy, const Chunk *c, std::vector<std::uint8_t> &tmp) {
+    out.i32(cx);
+    out.i32(cy);
+    if (!c) { out.u8(CHUNK_EMPTY); return; }
+    tmp.resize(CHUNK * CHUNK * 3);
+    std::size_t n = rle_encode(*c, tmp.data());
+    std::uint32_t partial = 0;
+    for (int i = 0; i < CHUNK * CHUNK; ++i) if (c->fluid[i] && is_fluid(c->tiles[i])) partial++;
+    std::uint8_t fluidFlag = partial ? CHUNK_FLUID : 0;
+    if (n < (std::size_t)CHUNK * CHUNK) {
+        out.u8(CHUNK_RLE | fluidFlag);
+        out.u32((std::uint32_t)n);
+        out.raw(tmp.data(), n);
+    } else {
+        out.u8(CHUNK_RAW | fluidFlag);
+        out.raw(c->tiles.data(), CHUNK * CHUNK);
+    }
+    if (!partial) return;
+    out.u32(partial);
+    for (int i = 0; i < CHUNK * CHUNK; ++i) {
+        if (!c->fluid[i] || !is_fluid(c->tiles[i])) continue;
+        out.u16((std::uint16_t)i);
+        out.u8(c->fluid[i]);
+    }
+}
+
+// Niveles de los fluidos parciales (ver write_chunk); false si no son válidos
+inline bool read_fluid_levels(ByteReader &in, Chunk &c) {
+    std::uint32_t n = in.u32();
+    if (!in.ok || n > (std::uint32_t)(CHUNK * CHUNK)) return false;
+    for (std::uint32_t k = 0; k < n; ++k) {
+        std::uint16_t i = in.u16();
+        std::uint8_t level = in.u8();
+        if (!in.ok || i >= CHUNK * CHUNK || level == 0 || level >= FLUID_MAX || !is_fluid(c.tiles[i])) return false;
+        c.fluid[i] = level;
+    }
+    return true;
+}
+
+// Lee un chunk; `c` queda nulo si era todo aire. Devuelve false si los datos no son válidos.
+inline bool read_chunk(ByteReader &in, int &cx, int &cy, std::unique_ptr<Chunk> &c) {
+    cx = in.i32();
+    cy = in.i32();
+    std::uint8_t enc = in.u8();
+    c.reset();
+    if (!in.ok) return false;
+    if (enc == CHUNK_EMPTY) return true;
+    bool fluid = (enc & CHUNK_FLUID) != 0;
+    enc &= ~CHUNK_FLUID;
+    c.reset(new Chunk());
+    if (enc == CHUNK_RLE) {
+        std::uint32_t n = in.u32();
+        const std::uint8_t *data = in.take(n);
+        if (!data || !rle_decode(data, n, *c)) return false;
+    } else if (enc == CHUNK_RAW) {
+        in.raw(c->tiles.data(), CHUNK * CHUNK);
+        for (BlockId b : c->tiles) if (b >= BLOCK_COUNT) return false;
+        if (!in.ok) return false;
+    } else {
+        return false;
+    }
+    return !fluid || read_fluid_levels(in, *c);
+}
+
+inline void put_chunk(World &world, int cx, int cy, std::unique_ptr<Chunk> c) {
+    if (c) world.insert_chunk(cx, cy, std::move(c));
+    else world.mark_generated(cx, cy);
+}
+
+inline void write_world(ByteWriter &out, const World &world) {
+    out.i32(world.width());
+    out.i32(world.height());
+    std::uint32_t count = 0;
+    world.for_each_generated([&](int, int, const Chunk *) { count++; });
+    out.u32(count);
+    std::vector<std::uint8_t> tmp;
+    world.for_each_generated([&](int cx, int cy, const Chunk *c) { write_chunk(out, cx, cy, c, tmp); });
+}
+
+// Reemplaza el contenido de `world`. Devuelve false si los datos no son válidos.
+inline bool read_world(ByteReader &in, World &world) {
+    int w = in.i32(), h = in.i32();
+    std::uint32_t count = in.u32();
+    if (!in.ok || w <= 0 || h <= 0) return false;
+    world.reset(w, h);
+    for (std::uint32_t k = 0; k < count; ++k) {
+        int cx, cy;
+        std::unique_ptr<Chunk> c;
+        if (!read_chunk(in, cx, cy, c)) return false;
+        put_chunk(world, cx, cy, std::move(c));
+    }
+    return in.ok;
+}
+
+} // namespace save
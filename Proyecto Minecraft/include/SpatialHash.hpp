@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Rejilla uniforme para consultar entidades por zona. Cada entidad (un id
+// pequeño, p.ej. su índice en el vector) se guarda como un punto en la celda que
+// lo contiene; update() solo la cambia de celda cuando cruza un borde. Las
+// consultas recorren únicamente las celdas que tocan el rectángulo pedido, así
+// que su coste depende de cuántas entidades hay cerca y no del total.
+// Quien consulta debe ampliar el rectángulo con la mitad del tamaño de sus
+// entidades (se indexa el centro) y hacer la prueba exacta sobre los candidatos.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize) : inv(1.0f / cellSize) {}
+
+    void clear() {
+        cells.clear();
+        cellOf.clear();
+        count = 0;
+    }
+
+    // Inserta la entidad `id` en (x, y) o la mueve ahí
+    void update(std::uint32_t id, float x, float y) {
+        std::uint64_t k = key(coord(x), coord(y));
+        if (id >= cellOf.size()) cellOf.resize(id + 1);
+        Slot &cur = cellOf[id];
+        if (cur.in && cur.key == k) return;
+        if (cur.in) erase_from(cur.key, id);
+        else count++;
+        cells[k].push_back(id);
+        cur.key = k;
+        cur.in = true;
+    }
+
+    void remove(std::uint32_t id) {
+        if (!contains(id)) return;
+        erase_from(cellOf[id].key, id);
+        cellOf[id].in = false;
+        count--;
+    }
+
+    bool contains(std::uint32_t id) const { return id < cellOf.size() && cellOf[id].in; }
+    std::size_t size() const { return count; }
+
+    // fn(id) para cada entidad en las celdas que tocan [x0, x1] x [y0, y1]
+    template <class Fn>
+    void query(float x0, float y0, float x1, float y1, Fn fn) const {
+        int cx0 = coord(x0), cx1 = coord(x1), cy0 = coord(y0), cy1 = coord(y1);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                auto it = cells.find(key(cx, cy));
+                if (it == cells.end()) continue;
+                for (std::uint32_t id : it->second) fn(id);
+            }
+        }
+    }
+
+    // Candidatos de query() ordenados por id: recorrerlos así no depende del
+    // historial de movimientos (importante para la simulación determinista)
+    void query_sorted(float x0, float y0, float x1, float y1, std::vector<std::uint32_t> &out) const {
+        out.clear();
+        query(x0, y0, x1, y1, [&out](std::uint32_t id) { out.push_back(id); });
+        std::sort(out.begin(), out.end());
+    }
+
+private:
+    struct Slot { std::uint64_t key = 0; bool in = false; };
+
+    int coord(float v) const { return (int)std::floor(v * inv); }
+    static std::uint64_t key(int cx, int cy) { return ((std::uint64_t)(std::uint32_t)cx << 32) | (std::uint32_t)cy; }
+
+    void erase_from(std::uint64_t k, std::uint32_t id) {
+        auto it = cells.find(k);
+        if (it == cells.end()) return;
+        auto &v = it->second;
+        auto pos = std::find(v.begin(), v.end(), id);
+        if (pos != v.end()) { *pos = v.back(); v.pop_back(); }
+    }
+
+    float inv; // 1 / lado de la celda
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;
+    std::vector<Slot> cellOf; // celda actual de cada id
+    std::size_t count = 0;
+};
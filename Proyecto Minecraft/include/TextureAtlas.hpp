@@ -0,0 +1,105 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Atlas de texturas: todas las imágenes de una carpeta se empaquetan al inicio
+// en una sola sf::Texture (empaquetado por estantes). Cada imagen queda como una
+// región en píxeles; los nombres solo se consultan al cargar, luego se usan
+// índices de región. La región 0 es un bloque blanco para dibujar quads de color
+// sólido en el mismo lote que los texturizados.
+class TextureAtlas {
+public:
+    static const int WHITE = 0;
+
+    // Carga y empaqueta todas las imágenes de `dir`. Devuelve false si no se pudo crear la textura.
+    bool build(const std::string &dir, unsigned maxWidth = 1024) {
+        namespace fs = std::filesystem;
+        struct Item { std::string name; sf::Image img; };
+        std::vector<Item> items;
+        {
+            Item white; white.name = ""; white.img.create(4, 4, sf::Color::White);
+            items.push_back(std::move(white));
+        }
+        if (fs::exists(dir)) {
+            for (auto &ent : fs::directory_iterator(dir)) {
+                if (!ent.is_regular_file()) continue;
+                Item it; it.name = ent.path().stem().string();
+                if (it.img.loadFromFile(ent.path().string())) items.push_back(std::move(it));
+            }
+        }
+        // más altas primero para que los estantes queden compactos
+        std::vector<int> order(items.size());
+        for (int i = 0; i < (int)order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin() + 1, order.end(), [&](int a, int b){ return items[a].img.getSize().y > items[b].img.getSize().y; });
+
+        const unsigned PAD = 1;
+        regions.assign(items.size(), sf::IntRect());
+        unsigned x = 0, y = 0, shelfH = 0, usedW = 0;
+        for (int idx : order) {
+            sf::Vector2u sz = items[idx].img.getSize();
+            if (x > 0 && x + sz.x > maxWidth) { y += shelfH + PAD; x = 0; shelfH = 0; }
+            regions[idx] = sf::IntRect((int)x, (int)y, (int)sz.x, (int)sz.y);
+            x += sz.x + PAD;
+            shelfH = std::max(shelfH, sz.y);
+            usedW = std::max(usedW, x);
+        }
+        sf::Image sheet;
+        sheet.create(std::max(1u, usedW), std::max(1u, y + shelfH), sf::Color::Transparent);
+        for (int i = 0; i < (int)items.size(); ++i) sheet.copy(items[i].img, (unsigned)regions[i].left, (unsigned)regions[i].top);
+        // muestrear solo el centro del bloque blanco para que el filtrado no toque el padding
+        regions[WHITE] = sf::IntRect(regions[WHITE].left + 1, regions[WHITE].top + 1, 2, 2);
+        names.clear();
+        for (int i = 1; i < (int)items.size(); ++i) names[items[i].name] = i;
+        return texture.loadFromImage(sheet);
+    }
+
+    // Índice de la primera región cuyo nombre coincide con algún candidato (o -1)
+    int find(std::initializer_list<const char*> candidates) const {
+        for (const char *c : candidates) {
+            auto it = names.find(c);
+            if (it != names.end()) return it->second;
+        }
+        return -1;
+    }
+
+    const sf::IntRect &region(int i) const { return regions[i]; }
+    const sf::Texture &getTexture() const { return texture; }
+
+private:
+    sf::Texture texture;
+    std::vector<sf::IntRect> regions;
+    std::unordered_map<std::string, int> names;
+};
+
+// Lote de quads texturizados sobre un atlas: se llena cada frame y se dibuja con una sola llamada.
+class SpriteBatch {
+public:
+    void clear() { vertices.clear(); }
+
+    void add(float x, float y, float w, float h, const sf::IntRect &uv, sf::Color col) {
+        float u0 = (float)uv.left, v0 = (float)uv.top;
+        float u1 = u0 + uv.width, v1 = v0 + uv.height;
+        vertices.append(sf::Vertex(sf::Vector2f(x, y), col, sf::Vector2f(u0, v0)));
+        vertices.append(sf::Vertex(sf::Vector2f(x + w, y), col, sf::Vector2f(u1, v0)));
+        vertices.append(sf::Vertex(sf::Vector2f(x + w, y + h), col, sf::Vector2f(u1, v1)));
+        vertices.append(sf::Vertex(sf::Vector2f(x, y + h), col, sf::Vector2f(u0, v1)));
+    }
+
+    void draw(sf::RenderTarget &target, const TextureAtlas &atlas) const {
+        if (vertices.getVertexCount() == 0) return;
+        sf::RenderStates states;
+        states.texture = &atlas.getTexture();
+        target.draw(vertices, states);
+    }
+
+    std::size_t size() const { return vertices.getVertexCount() / 4; }
+
+private:
+    sf::VertexArray vertices{sf::Quads};
+};
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Bits.hpp"
+#include "BlockTraits.hpp"
+
+// Almacenamiento del mundo por chunks (bloques de CHUNK x CHUNK tiles).
+// Los chunks viven en un hash map indexado por coordenada de chunk, así que las
+// coordenadas del mundo ya no dependen de un tamaño fijo en compilación y la
+// memoria crece con la zona que realmente contiene bloques: un chunk que solo
+// tendría aire (el cielo) nunca se reserva.
+// Un chunk puede estar sin generar (no hay entrada en el mapa), generado y todo
+// aire (entrada con puntero nulo) o con bloques. Mientras no se genera, get()
+// devuelve `unloaded` (aire por defecto; con generación en segundo plano se usa
+// un bloque sólido para que nada caiga en terreno que aún no existe).
+//
+// Cada chunk mantiene además máscaras de solidez de 64 bits por fila y por
+// columna (CHUNK = 64), así que las comprobaciones de suelo, los barridos de
+// colisión y las búsquedas de superficie miran 64 tiles por operación.
+//
+// La luz de cada tile (cielo y bloques, 0..15) también vive en el chunk; la
+// calcula LightEngine (Lighting.hpp) a partir de las zonas que el mundo anota
+// como pendientes cada vez que cambia un bloque o llega un chunk.
+//
+// Los chunks se guardan por referencia compartida: el autoguardado toma una
+// instantánea sin copiar nada (share_chunk) y el World copia un chunk compartido
+// justo antes de escribir en él (copia en escritura), así que la instantánea
+// nunca ve cambios posteriores.
+//
+// Los tiles de fluido (lava, agua) guardan además su nivel (Chunk::fluid) y cada
+// set() deja la posición en una cola de actualizaciones de bloques que consume
+// BlockPhysics (BlockPhysics.hpp) para despertar fluidos y bloques que caen.
+
+const int TILE = 32;
+const int CHUNK_SHIFT = 6;
+const int CHUNK = 1 << CHUNK_SHIFT; // 64 tiles por lado
+
+static_assert(CHUNK == 64, "las máscaras de solidez usan un uint64_t por fila/columna");
+
+const int MAX_LIGHT = 15;
+// Luz empaquetada de un tile: nibble alto = luz del cielo, bajo = luz de bloques
+inline std::uint8_t pack_light(int sky, int block) { return (std::uint8_t)((sky << 4) | block); }
+const std::uint8_t FULL_SKY_LIGHT = (std::uint8_t)(MAX_LIGHT << 4);
+
+// Rectángulo de tiles [x0, x1] x [y0, y1] (inclusivo)
+struct TileRect { int x0, y0, x1, y1; };
+
+struct TilePos { int x, y; };
+
+struct TileEdit { int x, y; BlockId block; };
+
+// Bits [lo, hi] a 1 (0 <= lo <= hi < 64)
+inline std::uint64_t bit_range(int lo, int hi) {
+    return (~0ull >> (63 - hi)) & (~0ull << lo);
+}
+
+struct Chunk {
+    std::array<BlockId, CHUNK * CHUNK> tiles;
+    std::array<std::uint64_t, CHUNK> solidRows; // bit lx de solidRows[ly]: tile (lx, ly) sólido
+    std::array<std::uint64_t, CHUNK> solidCols; // bit ly de solidCols[lx]
+    std::array<std::uint8_t, CHUNK * CHUNK> light; // pack_light(cielo, bloques); a pleno cielo hasta que se ilumina
+    std::array<std::uint8_t, CHUNK * CHUNK> fluid; // nivel de los tiles de fluido: 0 = lleno, 1..FLUID_MAX-1 = parcial
+    std::uint64_t revision = 0; // cambia con cada edición; único en todo el mundo (lo usan los caches de render)
+
+    Chunk() { tiles.fill(AIR); solidRows.fill(0); solidCols.fill(0); light.fill(FULL_SKY_LIGHT); fluid.fill(0); }
+
+    // Nivel de fluido (1..FLUID_MAX) del tile, 0 si no es un fluido
+    int fluid_level(int lx, int ly) const {
+        int i = ly * CHUNK + lx;
+        if (!is_fluid(tiles[i])) return 0;
+        return fluid[i] ? fluid[i] : FLUID_MAX;
+    }
+
+    BlockId at(int lx, int ly) const { return tiles[ly * CHUNK + lx]; }
+    // Escritura directa (generación, carga): después hay que llamar a rebuild_solidity()
+    BlockId &at(int lx, int ly) { return tiles[ly * CHUNK + lx]; }
+
+    void set(int lx, int ly, BlockId b) {
+        tiles[ly * CHUNK + lx] = b;
+        std::uint64_t rowBit = 1ull << lx, colBit = 1ull << ly;
+        if (block_traits(b).solid) { solidRows[ly] |= rowBit; solidCols[lx] |= colBit; }
+        else { solidRows[ly] &= ~rowBit; solidCols[lx] &= ~colBit; }
+    }
+
+    void rebuild_solidity() {
+        solidCols.fill(0);
+        for (int ly = 0; ly < CHUNK; ++ly) {
+            std::uint64_t row = 0;
+            const BlockId *t = tiles.data() + ly * CHUNK;
+            for (int lx = 0; lx < CHUNK; ++lx) row |= (std::uint64_t)block_traits(t[lx]).solid << lx;
+            solidRows[ly] = row;
+            for (std::uint64_t m = row; m; m &= m - 1) solidCols[lowest_bit(m)] |= 1ull << ly;
+        }
+    }
+};
+
+class World {
+public:
+    World() {}
+
+    // Define los límites jugables del mundo (en tiles) y descarta los chunks existentes
+    void reset(int width, int height) {
+        w = width; h = height;
+        chunks.clear();
+        dirty.clear();
+        lightDirty.clear();
+        blockUpdates.clear();
+        allocated = 0;
+        edits++;
+    }
+
+    void set_unloaded_block(BlockId b) {
+        unloaded = b;
+        unloadedRow.fill(b);
+        unloadedMask = block_traits(b).solid ? ~0ull : 0ull;
+        edits++;
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    bool in_bounds(int x, int y) const { return x >= 0 && x < w && y >= 0 && y < h; }
+
+    BlockId get(int x, int y) const {
+        auto it = chunks.find(key(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+        if (it == chunks.end()) return unloaded;
+        if (!it->second) return AIR;
+        return it->second->at(x & (CHUNK - 1), y & (CHUNK - 1));
+    }
+
+    // Pone el bloque b en (x, y); si es un fluido, con nivel `level` (1..FLUID_MAX)
+    void set(int x, int y, BlockId b, int level = FLUID_MAX) {
+        int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT;
+        Chunk *c = find_chunk(cx, cy);
+        if (!c) {
+            if (b == AIR) return; // aire sobre un chunk vacío: nada que guardar
+            c = &create_chunk(cx, cy);
+            lightDirty.push_back(chunk_rect(cx, cy)); // su luz aún es la de cielo abierto
+        }
+        int lx = x & (CHUNK - 1), ly = y & (CHUNK - 1);
+        std::uint8_t lv = (std::uint8_t)(is_fluid(b) && level < FLUID_MAX ? level : 0);
+        bool blockChanged = c->at(lx, ly) != b;
+        if (!blockChanged && c->fluid[ly * CHUNK + lx] == lv) return;
+        c->fluid[ly * CHUNK + lx] = lv;
+        c->revision = next_revision();
+        dirty.insert(key(cx, cy));
+        blockUpdates.push_back(TilePos{x, y});
+        if (!blockChanged) return; // solo cambió el nivel: ni la luz ni la solidez
+        c->set(lx, ly, b);
+        lightDirty.push_back(TileRect{x, y, x, y});
+        edits++;
+    }
+
+    // Aplica varias ediciones de una vez (p.ej. una explosión); ordena `batch` por chunk.
+    // Los bloques quedan igual que con set() tile a tile, pero cada chunk tocado
+    // cambia de revisión, se anota para el guardado y pide luz una sola vez (el
+    // rectángulo de sus tiles cambiados). Las ediciones fuera del mundo se ignoran.
+    void set_batch(std::vector<TileEdit> &batch) {
+        auto chunkOf = [](const TileEdit &e) { return key(e.x >> CHUNK_SHIFT, e.y >> CHUNK_SHIFT); };
+        std::sort(batch.begin(), batch.end(), [&](const TileEdit &a, const TileEdit &b) {
+            std::uint64_t ka = chunkOf(a), kb = chunkOf(b);
+            return ka != kb ? ka < kb : (a.y != b.y ? a.y < b.y : a.x < b.x);
+        });
+        for (std::size_t i = 0; i < batch.size();) {
+            std::size_t end = i;
+            while (end < batch.size() && chunkOf(batch[end]) == chunkOf(batch[i])) ++end;
+            int cx = batch[i].x >> CHUNK_SHIFT, cy = batch[i].y >> CHUNK_SHIFT;
+            Chunk *c = find_chunk(cx, cy);
+            TileRect r{w, h, -1, -1};
+            for (std::size_t k = i; k < end; ++k) {
+                const TileEdit &e = batch[k];
+                if (!in_bounds(e.x, e.y)) continue;
+                if (!c) {
+                    if (e.block == AIR) continue;
+                    c = &create_chunk(cx, cy);
+                    lightDirty.push_back(chunk_rect(cx, cy));
+                }
+                int lx = e.x & (CHUNK - 1), ly = e.y & (CHUNK - 1);
+                if (c->at(lx, ly) == e.block && c->fluid[ly * CHUNK + lx] == 0) continue;
+                c->set(lx, ly, e.block);
+                c->fluid[ly * CHUNK + lx] = 0;
+                blockUpdates.push_back(TilePos{e.x, e.y});
+                r = TileRect{std::min(r.x0, e.x), std::min(r.y0, e.y), std::max(r.x1, e.x), std::max(r.y1, e.y)};
+            }
+            if (r.x1 >= 0) {
+                c->revision = next_revision();
+                dirty.insert(key(cx, cy));
+                lightDirty.push_back(r);
+                edits++;
+            }
+            i = end;
+        }
+    }
+
+    // Nivel de fluido (1..FLUID_MAX) del tile, 0 si no es un fluido o no hay chunk
+    int fluid_level(int x, int y) const {
+        const Chunk *c = find_chunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        return c ? c->fluid_level(x & (CHUNK - 1), y & (CHUNK - 1)) : 0;
+    }
+
+    // Tiles cambiados con set() desde la última llamada (para BlockPhysics)
+    std::vector<TilePos> take_block_updates() {
+        std::vector<TilePos> out;
+        out.swap(blockUpdates);
+        return out;
+    }
+
+    // Cuenta de cambios de bloques (set, chunks que llegan): si no cambió, el mundo tampoco
+    std::uint64_t edit_count() const { return edits; }
+
+    // Luz del tile (x, y). Un chunk todo aire cuenta como cielo abierto; uno sin
+    // generar, según el bloque `unloaded`; fuera del mundo, cielo por arriba y oscuridad por lo demás.
+    std::uint8_t light_at(int x, int y) const {
+        if (!in_bounds(x, y)) return y < 0 ? FULL_SKY_LIGHT : 0;
+        auto it = chunks.find(key(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+        if (it == chunks.end()) return unloadedMask ? 0 : FULL_SKY_LIGHT;
+        if (!it->second) return FULL_SKY_LIGHT;
+        return it->second->light[(y & (CHUNK - 1)) * CHUNK + (x & (CHUNK - 1))];
+    }
+
+    // Zonas cuyos bloques cambiaron desde la última llamada (para LightEngine)
+    std::vector<TileRect> take_light_dirty() {
+        std::vector<TileRect> out;
+        out.swap(lightDirty);
+        return out;
+    }
+
+    // La luz del chunk cambió: nueva revisión para que los caches de render lo rehagan
+    void mark_relit(Chunk &c) { c.revision = next_revision(); }
+
+    // Tiles de la fila y desde x hasta el final de su chunk (CHUNK - x % CHUNK tiles),
+    // sin comprobar límites por tile: el llamador ya validó que (x, y) está en el mundo.
+    const BlockId *row_span(int x, int y) const {
+        int lx = x & (CHUNK - 1);
+        auto it = chunks.find(key(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+        if (it == chunks.end()) return unloadedRow.data() + lx;
+        if (!it->second) return airRow.data() + lx;
+        return &it->second->tiles[(y & (CHUNK - 1)) * CHUNK + lx];
+    }
+
+    // Primer y en [y0, y1] con un tile sólido en la columna x, o -1
+    int first_solid_in_col(int x, int y0, int y1) const {
+        if (x < 0 || x >= w) return -1;
+        y0 = std::max(y0, 0); y1 = std::min(y1, h - 1);
+        for (int y = y0; y <= y1; y = (y | (CHUNK - 1)) + 1) {
+            int hi = std::min(y1, y | (CHUNK - 1));
+            std::uint64_t m = col_mask(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, x & (CHUNK - 1)) & bit_range(y & (CHUNK - 1), hi & (CHUNK - 1));
+            if (m) return (y & ~(CHUNK - 1)) + lowest_bit(m);
+        }
+        return -1;
+    }
+
+    // Primer y en [y0, y1] de la columna x con un tile no sólido justo encima de uno
+    // sólido (donde algo puede quedarse de pie), o -1. Solo mira dentro del mundo.
+    int first_floor_in_col(int x, int y0, int y1) const {
+        if (x < 0 || x >= w) return -1;
+        y0 = std::max(y0, 0); y1 = std::min(y1, h - 2);
+        for (int y = y0; y <= y1; y = (y | (CHUNK - 1)) + 1) {
+            int cy = y >> CHUNK_SHIFT, lx = x & (CHUNK - 1);
+            int hi = std::min(y1, y | (CHUNK - 1));
+            std::uint64_t s = col_mask(x >> CHUNK_SHIFT, cy, lx);
+            std::uint64_t below = (s >> 1) | (col_mask(x >> CHUNK_SHIFT, cy + 1, lx) << 63); // bit ly: sólido en ly+1
+            std::uint64_t m = ~s & below & bit_range(y & (CHUNK - 1), hi & (CHUNK - 1));
+            if (m) return (y & ~(CHUNK - 1)) + lowest_bit(m);
+        }
+        return -1;
+    }
+
+    const Chunk *find_chunk(int cx, int cy) const {
+        auto it = chunks.find(key(cx, cy));
+        return it == chunks.end() ? nullptr : it->second.get();
+    }
+    // Para escribir en el chunk: si alguna instantánea lo comparte, antes se copia
+    Chunk *find_chunk(int cx, int cy) {
+        auto it = chunks.find(key(cx, cy));
+        return it == chunks.end() ? nullptr : unshare(it->second);
+    }
+
+    Chunk &create_chunk(int cx, int cy) {
+        auto &slot = chunks[key(cx, cy)];
+        if (!slot) { slot = std::make_shared<Chunk>(); slot->revision = next_revision(); allocated++; }
+        return *unshare(slot);
+    }
+
+    // El chunk (cx, cy) tal como está ahora (nullptr si es todo aire o no está
+    // generado). No copia nada: los cambios posteriores del World no le llegan.
+    std::shared_ptr<const Chunk> share_chunk(int cx, int cy) const {
+        auto it = chunks.find(key(cx, cy));
+        return it == chunks.end() ? nullptr : it->second;
+    }
+
+    // Chunks editados con set() desde la última llamada (para el autoguardado incremental)
+    std::vector<std::uint64_t> take_dirty() {
+        std::vector<std::uint64_t> keys(dirty.begin(), dirty.end());
+        dirty.clear();
+        return keys;
+    }
+
+    bool is_generated(int cx, int cy) const { return chunks.count(key(cx, cy)) != 0; }
+
+    // Marca el chunk como generado y todo aire (no reserva memoria)
+    void mark_generated(int cx, int cy) {
+        if (chunks.emplace(key(cx, cy), nullptr).second) { lightDirty.push_back(chunk_rect(cx, cy)); edits++; }
+    }
+
+    // Máscara con la que cuenta una fila/columna de un chunk sin generar
+    std::uint64_t unloaded_mask() const { return unloadedMask; }
+
+    // Máscara de solidez de una columna del chunk (cx, cy), también para
+    // chunks vacíos (0) o sin generar (según el bloque `unloaded`)
+    std::uint64_t col_mask(int cx, int cy, int lx) const {
+        auto it = chunks.find(key(cx, cy));
+        if (it == chunks.end()) return unloadedMask;
+        return it->second ? it->second->solidCols[lx] : 0ull;
+    }
+
+    // Hash FNV-1a del contenido: dimensiones y todos los tiles dentro de los límites, fila a fila,
+    // más el índice y el nivel de cada fluido parcial (un mundo sin ellos da el mismo hash que sin niveles).
+    // No depende de qué chunks estén reservados (uno ausente cuenta como aire),
+    // así que dos mundos con los mismos bloques dan el mismo hash.
+    std::uint64_t content_hash() const {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        auto mix = [&hash](std::uint32_t v, int bytes) {
+            for (int i = 0; i < bytes; ++i) { hash ^= (v >> (8 * i)) & 0xFFu; hash *= 0x100000001B3ull; }
+        };
+        mix((std::uint32_t)w, 4);
+        mix((std::uint32_t)h, 4);
+        for (int y = 0; y < h; ++y) {
+            for (int cx = 0; cx * CHUNK < w; ++cx) {
+                const Chunk *c = find_chunk(cx, y >> CHUNK_SHIFT);
+                const BlockId *row = c ? &c->tiles[(y & (CHUNK - 1)) * CHUNK] : airRow.data();
+                int n = std::min(CHUNK, w - cx * CHUNK);
+                for (int lx = 0; lx < n; ++lx) mix(row[lx], 1);
+                if (!c) continue;
+                const std::uint8_t *level = &c->fluid[(y & (CHUNK - 1)) * CHUNK];
+                for (int lx = 0; lx < n; ++lx) {
+                    if (!level[lx]) continue;
+                    mix((std::uint32_t)y * (std::uint32_t)w + (std::uint32_t)(cx * CHUNK + lx), 4);
+                    mix(level[lx], 1);
+                }
+            }
+        }
+        return hash;
+    }
+
+    // Reemplaza el chunk (cx, cy) por uno ya generado (toma posesión del puntero)
+    void insert_chunk(int cx, int cy, std::unique_ptr<Chunk> c) {
+        c->rebuild_solidity();
+        c->revision = next_revision();
+        auto &slot = chunks[key(cx, cy)];
+        if (!slot) allocated++;
+        slot = std::move(c);
+        lightDirty.push_back(chunk_rect(cx, cy));
+        edits++;
+    }
+
+    // Recorre los chunks generados en orden (cy, cx); `fn(cx, cy, chunk)` recibe nullptr si es todo aire
+    template <class Fn>
+    void for_each_generated(Fn fn) const {
+        std::vector<std::uint64_t> keys;
+        keys.reserve(chunks.size());
+        for (auto &kv : chunks) keys.push_back(kv.first);
+        std::sort(keys.begin(), keys.end(), [](std::uint64_t a, std::uint64_t b) {
+            return std::make_pair((std::int32_t)(std::uint32_t)a, (std::int32_t)(a >> 32)) < std::make_pair((std::int32_t)(std::uint32_t)b, (std::int32_t)(b >> 32));
+        });
+        for (std::uint64_t k : keys) fn((std::int32_t)(k >> 32), (std::int32_t)(std::uint32_t)k, chunks.find(k)->second.get());
+    }
+
+    std::size_t chunk_count() const { return allocated; }
+    std::size_t memory_bytes() const { return allocated * sizeof(Chunk); }
+
+    static std::uint64_t key(int cx, int cy) {
+        return ((std::uint64_t)(std::uint32_t)cx << 32) | (std::uint32_t)cy;
+    }
+
+private:
+    static Chunk *unshare(std::shared_ptr<Chunk> &slot) {
+        if (!slot) return nullptr;
+        if (slot.use_count() > 1) slot = std::make_shared<Chunk>(*slot);
+        else std::atomic_thread_fence(std::memory_order_acquire); // lo que leyó el hilo que soltó la última referencia ya terminó
+        return slot.get();
+    }
+
+    static TileRect chunk_rect(int cx, int cy) {
+        return TileRect{cx * CHUNK, cy * CHUNK, cx * CHUNK + CHUNK - 1, cy * CHUNK + CHUNK - 1};
+    }
+
+    // Contador de revisiones compartido por todos los World: un mundo cargado o
+    // regenerado nunca repite una revisión que un cache de render ya haya visto.
+    static std::uint64_t next_revision() {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    int w = 0, h = 0;
+    std::size_t allocated = 0;
+    std::unordered_set<std::uint64_t> dirty;
+    std::vector<TileRect> lightDirty;
+    std::vector<TilePos> blockUpdates;
+    std::uint64_t edits = 0;
+    BlockId unloaded = AIR;
+    std::uint64_t unloadedMask = 0;
+    std::array<BlockId, CHUNK> unloadedRow{}; // filas para row_span() sobre chunks sin generar / vacíos
+    std::array<BlockId, CHUNK> airRow{};
+    std::unordered_map<std::uint64_t, std::shared_ptr<Chunk>> chunks;
+};
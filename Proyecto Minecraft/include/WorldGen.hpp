@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "Noise.hpp"
+#include "Random.hpp"
+#include "World.hpp"
+
+// Generador de terreno por ruido. Cada tile es función pura de (semilla, x, y):
+// altura de la superficie y bioma salen de ruido 1D por columna, cuevas y vetas
+// de mineral de ruido 2D, y los árboles de coord_hash por columna. Así cualquier
+// chunk se puede generar por separado, en cualquier orden, con el mismo resultado.
+//
+// Biomas: una "temperatura" de baja frecuencia elige desierto / pradera / nieve.
+// Cerca de la frontera la altura se mezcla con pesos suaves y el bloque de
+// superficie se sortea según esos pesos, así que no hay cortes bruscos.
+class WorldGen {
+public:
+    enum Biome { DESERT = 0, PLAINS = 1, TUNDRA = 2 };
+
+    struct Column {
+        int surface = 0; // y del primer bloque sólido
+        int biome = PLAINS;
+        int tree = 0;    // altura del tronco (0 = sin árbol)
+    };
+
+    WorldGen(std::uint64_t seed, int width, int height) : seed(seed), w(width), h(height) {
+        std::uint64_t s = seed;
+        heightSeed = (std::uint32_t)splitmix64(s);
+        detailSeed = (std::uint32_t)splitmix64(s);
+        biomeSeed = (std::uint32_t)splitmix64(s);
+        caveSeed = (std::uint32_t)splitmix64(s);
+        cavernSeed = (std::uint32_t)splitmix64(s);
+        oreSeed = (std::uint32_t)splitmix64(s);
+        nethDepth = std::max(6, h / 12);
+    }
+
+    // Columnas [x0, x0+n): altura, bioma y árbol (n <= MAX_COLUMNS)
+    static const int MAX_COLUMNS = CHUNK + 4;
+    void columns(int x0, int n, Column *out) const {
+        float hn[MAX_COLUMNS], dn[MAX_COLUMNS], tn[MAX_COLUMNS];
+        noise::fbm1_row(heightSeed, (float)x0, 1.0f, 1.0f / 96.0f, 4, n, hn);
+        noise::fbm1_row(detailSeed, (float)x0, 1.0f, 1.0f / 9.0f, 2, n, dn);
+        noise::fbm1_row(biomeSeed, (float)x0, 1.0f, 1.0f / 220.0f, 3, n, tn);
+        float base = h / 3.0f;
+        for (int i = 0; i < n; ++i) {
+            int x = x0 + i;
+            float wd, wp, ws;
+            biome_weights(tn[i], wd, wp, ws);
+            // perfil de altura por bioma (y crece hacia abajo: restar = más alto)
+            float hDesert = base + h / 24.0f - hn[i] * (h / 24.0f);
+            float hPlains = base + h / 12.0f - hn[i] * (h / 8.0f);
+            float hTundra = base - hn[i] * (h / 5.0f);
+            float sy = wd * hDesert + wp * hPlains + ws * hTundra + dn[i] * 1.5f;
+            Column &c = out[i];
+            c.surface = std::max(2, std::min(h - 6, (int)std::floor(sy)));
+            // el bioma de la columna se sortea con los pesos: frontera difusa
+            float roll = (float)(coord_hash(seed, RNG_TERRAIN, x, -1) >> 40) * (1.0f / 16777216.0f);
+            c.biome = roll < wd ? DESERT : (roll < wd + wp ? PLAINS : TUNDRA);
+            c.tree = 0;
+            if (x >= 2 && x < w - 2 && c.biome != DESERT) {
+                std::uint64_t treeRoll = coord_hash(seed, RNG_TREES, x, 0);
+                int treeChance = c.biome == TUNDRA ? 18 : 12;
+                if ((int)(treeRoll % 100) < treeChance) c.tree = 2 + (int)((treeRoll >> 32) % 3); // 2..4
+            }
+        }
+    }
+
+    // Rellena `c` con el chunk (cx, cy). Devuelve false si quedó todo aire.
+    bool generate_chunk(int cx, int cy, Chunk &c) const {
+        c.tiles.fill(AIR);
+        int x0 = cx * CHUNK, y0 = cy * CHUNK;
+        if (x0 >= w || y0 >= h || x0 + CHUNK <= 0 || y0 + CHUNK <= 0) return false;
+        // columnas del chunk más 2 a cada lado (las copas de los árboles cruzan chunks)
+        Column cols[MAX_COLUMNS];
+        columns(x0 - 2, CHUNK + 4, cols);
+        const Column *col = cols + 2;
+        int minSurface = h;
+        for (int i = -2; i < CHUNK + 2; ++i) minSurface = std::min(minSurface, col[i].surface - col[i].tree - 3);
+        if (y0 + CHUNK <= minSurface) return false; // cielo
+
+        bool any = false;
+        float cave[CHUNK], cavern[CHUNK], ore[CHUNK];
+        for (int ly = 0; ly < CHUNK; ++ly) {
+            int y = y0 + ly;
+            if (y < 0 || y >= h) continue;
+            bool rowNoise = false;
+            for (int lx = 0; lx < CHUNK; ++lx) {
+                int x = x0 + lx;
+                if (x < 0 || x >= w) continue;
+                BlockId b = base_block(col, lx, x, y);
+                if (b == STONE || b == DIRT || b == SAND || b == NETH) {
+                    if (!rowNoise) {
+                        noise::fbm2_row(caveSeed, (float)x0, 1.0f, 1.0f / 22.0f, (float)y, 1.0f / 14.0f, 3, CHUNK, cave);
+                        noise::fbm2_row(cavernSeed, (float)x0, 1.0f, 1.0f / 48.0f, (float)y, 1.0f / 28.0f, 2, CHUNK, cavern);
+                        noise::fbm2_row(oreSeed, (float)x0, 1.0f, 1.0f / 7.0f, (float)y, 1.0f / 7.0f, 2, CHUNK, ore);
+                        rowNoise = true;
+                    }
+                    b = carve(b, x, y, col[lx].surface, cave[lx], cavern[lx], ore[lx]);
+                }
+                c.at(lx, ly) = b;
+                if (b != AIR) any = true;
+            }
+        }
+        return any;
+    }
+
+private:
+    // pesos de bioma (suman 1) a partir de la temperatura
+    static void biome_weights(float t, float &wd, float &wp, float &ws) {
+        wd = smooth(-0.12f, -0.28f, t);
+        ws = smooth(0.12f, 0.28f, t);
+        wp = 1.0f - wd - ws;
+    }
+    static float smooth(float e0, float e1, float x) {
+        float t = std::max(0.0f, std::min(1.0f, (x - e0) / (e1 - e0)));
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // Bloque antes de cuevas y minerales: capas del bioma, árboles, infierno y bedrock
+    BlockId base_block(const Column *col, int lx, int x, int y) const {
+        const Column &c = col[lx];
+        if (y == h - 1) return BEDR;
+        if (y >= h - 1 - nethDepth) {
+            if (y >= h - 2 && coord_hash(seed, RNG_TERRAIN, x, y) % 100 < 40) return LAVA;
+            return NETH;
+        }
+        if (y >= c.surface) {
+            if (y == c.surface) return c.biome == DESERT ? SAND : (c.biome == TUNDRA ? SNOW : GRASS);
+            if (y < c.surface + 4) return c.biome == DESERT ? SAND : DIRT;
+            return STONE;
+        }
+        // sobre la superficie: tronco propio o copa de un árbol vecino (5x3 sobre el tronco)
+        if (c.tree && y >= c.surface - c.tree) return WOOD;
+        for (int dx = -2; dx <= 2; ++dx) {
+            const Column &t = col[lx + dx];
+            if (!t.tree) continue;
+            int topY = t.surface - t.tree;
+            if (y >= topY - 2 && y <= topY) return t.biome == TUNDRA ? SNOW : LEAF;
+        }
+        return AIR;
+    }
+
+    // Cuevas (túneles donde el ruido cruza cero + cavernas grandes) y vetas de mineral en la piedra
+    BlockId carve(BlockId b, int x, int y, int surface, float caveN, float cavernN, float oreN) const {
+        if (y > surface + 2 && y < h - 2) {
+            float depth = (float)(y - surface) / (float)std::max(1, h - surface);
+            float width = 0.05f + 0.05f * depth; // túneles más anchos en profundidad
+            if (std::abs(caveN) < width || cavernN > 0.5f - 0.1f * depth) return AIR;
+        }
+        if (b != STONE || y < 2 || y >= h - 2 || x < 1 || x >= w - 1) return b;
+        int r = (int)(coord_hash(seed, RNG_ORES, x, y) % 1000);
+        float scale = oreN > 0.3f ? 3.0f : 0.45f; // dentro de una veta es mucho más probable
+        // carbón: más frecuente en capas superiores de roca
+        if (r < 40 * scale && y < h / 2) return COAL;
+        // hierro: menos frecuente y más profundo
+        if (r < 52 * scale && y >= h / 4 && y < (3 * h) / 4) return IRON;
+        // oro: raro, profundo
+        if (r < 55 * scale && y > (3 * h) / 4) return GOLD;
+        return b;
+    }
+
+    std::uint64_t seed;
+    int w, h;
+    int nethDepth;
+    std::uint32_t heightSeed, detailSeed, biomeSeed, caveSeed, cavernSeed, oreSeed;
+};
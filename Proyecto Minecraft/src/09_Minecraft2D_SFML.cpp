@@ -1,384 +1,1678 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <array>
-#include <map>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
 
+#include "World.hpp"
+#include "BlockTraits.hpp"
+#include "Items.hpp"
+#include "ChunkMesh.hpp"
+#include "TextureAtlas.hpp"
+#include "Profiler.hpp"
+#include "Random.hpp"
+#include "WorldGen.hpp"
+#include "ChunkStreamer.hpp"
+#include "Collision.hpp"
+#include "SaveFormat.hpp"
+#include "SpatialHash.hpp"
+#include "EnemyStore.hpp"
+#include "FlowField.hpp"
+#include "JobSystem.hpp"
+#include "Lighting.hpp"
+#include "BlockPhysics.hpp"
+#include "Explosions.hpp"
+#include "ParticlePool.hpp"
+#include "Autosave.hpp"
+
 // Ejemplo 2D tipo "Minecraft" usando SFML con físicas básicas solo para el jugador
 // Características añadidas:
 // - Física vertical: gravedad, salto, velocidad y colisión con tiles sólidos
 // - Mapa más grande y una cueva/túnel subterráneo
 
-// Map size increased: larger world while window/view remains the same
+// Tamaño por defecto del mundo generado (en tiles). Ya no limita las coordenadas:
+// el mundo se guarda por chunks (ver World.hpp) y sus límites son de tiempo de ejecución.
 const int W = 240;
 const int H = 120;
-const int TILE = 32;
-
-enum Block : char { AIR = ' ', GRASS = 'G', DIRT = 'D', STONE = 'S', WOOD = 'W', BEDR = 'B', LEAF = 'L', COAL = 'c', IRON = 'i', GOLD = 'o' };
-// New biomes blocks
-enum ExtraBlock : char { SAND = 'N', SNOW = 'Y', NETH = 'H', LAVA = 'V' };
-
-using World = std::vector<std::string>;
 
 struct Player {
     float px, py; // posición en píxeles
     float vx, vy; // velocidad en píxeles/s
     int fx, fy;   // dirección de mirada (-1/0/1 en x, y)
-    char selected;
-    std::map<char,int> inv;
-    std::map<std::string,int> tools; // herramientas: "pickaxe","axe","shovel"
-    std::string selectedTool; // key of selected tool
+    BlockId selected;
+    Inventory inv; // bloques y herramientas (ver Items.hpp)
+    Tool selectedTool; // herramienta seleccionada (TOOL_NONE = mano)
     float w, h; // tamaño del rectángulo del jugador
+    float prevPx, prevPy; // posición al inicio del último tick (para interpolar el render)
 };
 
-bool in_bounds(int x,int y){ return x>=0 && x<W && y>=0 && y<H; }
-bool isSolid(char b){ return b!=(char)AIR; }
-
-char get_block(const World &w, int x,int y){ if(!in_bounds(x,y)) return (char)BEDR; return w[y][x]; }
-void set_block(World &w,int x,int y,char b){ if(in_bounds(x,y)) w[y][x]=b; }
-
-void init_world(World &world) {
-    // Procedural: generar altura de superficie por columna y cavidades/túneles
-    world.assign(H, std::string(W, (char)AIR));
-    std::srand((unsigned)time(nullptr));
-    std::vector<int> height(W);
-    for (int x = 0; x < W; ++x) {
-        float t = (float)x / (float)W * 6.2831853f; // 2*pi
-        float base = (std::sin(t * 0.7f) + 1.0f) * 0.5f; // 0..1
-        int h = (int)((H / 3) + base * (H / 6)) + (std::rand() % 3 - 1);
-        h = std::max(2, std::min(H-6, h));
-        height[x] = h;
+bool in_bounds(const World &w, int x,int y){ return w.in_bounds(x,y); }
+bool isSolid(BlockId b){ return block_traits(b).solid; }
+
+// Herramienta en mano (solo cuenta si el jugador la tiene)
+Tool held_tool(const Player &p) {
+    return (p.selectedTool != TOOL_NONE && p.inv.has(tool_item(p.selectedTool))) ? p.selectedTool : TOOL_NONE;
+}
+
+// Selecciona `t` si el jugador la tiene; si no, se queda con la mano
+void select_tool(Player &p, Tool t) {
+    p.selectedTool = p.inv.has(tool_item(t)) ? t : TOOL_NONE;
+}
+
+BlockId get_block(const World &w, int x,int y){ if(!w.in_bounds(x,y)) return BEDR; return w.get(x,y); }
+void set_block(World &w,int x,int y,BlockId b){ if(w.in_bounds(x,y)) w.set(x,y,b); }
+
+// Genera los chunks que aún faltan dentro del mundo: todos, o con `nearCx` >= 0 solo
+// las columnas de chunks a una de distancia (el resto lo entrega ChunkStreamer).
+// Los que quedan todo aire (el cielo) se marcan como generados sin reservar memoria.
+void generate_missing_chunks(World &world, std::uint64_t seed, int nearCx = -1) {
+    WorldGen gen(seed, world.width(), world.height());
+    int chunksX = (world.width() + CHUNK - 1) / CHUNK, chunksY = (world.height() + CHUNK - 1) / CHUNK;
+    std::unique_ptr<Chunk> c(new Chunk());
+    for (int cy = 0; cy < chunksY; ++cy) {
+        for (int cx = 0; cx < chunksX; ++cx) {
+            if (nearCx >= 0 && std::abs(cx - nearCx) > 1) continue;
+            if (world.is_generated(cx, cy)) continue;
+            if (!gen.generate_chunk(cx, cy, *c)) { world.mark_generated(cx, cy); continue; }
+            world.insert_chunk(cx, cy, std::move(c));
+            c.reset(new Chunk());
+        }
     }
+}
 
-    // rellenar suelo según heights, aplicando biomas: left third = desert, middle = normal, right = snow
-    for (int x = 0; x < W; ++x) {
-        int g = height[x];
-        int region = (x * 3) / W; // 0,1,2
-        for (int y = g; y < H-1; ++y) {
-            if (y == g) {
-                if (region == 0) world[y][x] = (char)SAND; // desert
-                else if (region == 2) world[y][x] = (char)SNOW; // snow
-                else world[y][x] = (char)GRASS;
-            }
-            else if (y < g + 4) {
-                if (region == 0) world[y][x] = (char)SAND;
-                else world[y][x] = (char)DIRT;
-            }
-            else world[y][x] = (char)STONE;
+void init_world(World &world, std::uint64_t seed, int width = W, int height = H, bool streaming = false) {
+    // Procedural por ruido (WorldGen.hpp): superficie y biomas por columna, cuevas,
+    // minerales, árboles e infierno.
+    // Con `streaming` solo se generan aquí las columnas de chunks del spawn y el resto
+    // lo va entregando ChunkStreamer; mientras tanto lo no generado cuenta como sólido.
+    world.reset(width, height);
+    world.set_unloaded_block(streaming ? BEDR : AIR);
+    generate_missing_chunks(world, seed, streaming ? (width / 2) / CHUNK : -1);
+}
+
+// ---------------------------------------------------------------------------
+// Simulación: todo lo que avanza el estado del juego vive en GameState y se
+// actualiza en sim_tick() con un paso de tiempo fijo. El render (main) solo
+// lee el estado e interpola posiciones entre el tick anterior y el actual.
+// ---------------------------------------------------------------------------
+
+const float GRAVITY = 1500.0f; // px/s^2
+const float MAX_FALL_SPEED = 2000.0f; // px/s
+const float MOVE_SPEED = 150.0f; // px/s
+const float JUMP_SPEED = 520.0f; // px/s
+// Sword (attack) mechanics
+const float SWING_RANGE = 64.0f; // px (increased reach)
+const float SWING_COOLDOWN = 0.5f; // s (quicker swings)
+const float SWING_ACTIVE = 0.15f; // s (shorter hit window)
+const float ENEMY_RESPAWN_BASE = 8.0f; // base seconds before enemy can respawn (faster)
+const float ENEMY_RESPAWN_VAR = 4.0f; // random additional seconds (0..VAR)
+const int SWORD_DAMAGE = 1; // damage per hit
+const int EXPLOSION_DAMAGE = 2; // daño de un creeper a los enemigos que alcanza
+const float EXPLOSION_RADIUS = 2.5f * TILE; // px: alcance de la explosión de un creeper (bloques y daño)
+const float EXPLOSION_POWER = 3.0f; // fuerza en el centro (ver BlockTraits::blastResistance)
+const int DROP_CHANCE = 30; // % de los bloques rotos por una explosión que caen como objeto
+const std::size_t MAX_DROPS = 256; // objetos sueltos a la vez como mucho
+const float DROP_SIZE = 12.0f; // px
+const float DROP_LIFE = 60.0f; // s hasta que desaparece un objeto que nadie recoge
+const float ACTIVE_RANGE = 1200.0f; // px: los enemigos más lejos del jugador no se simulan
+const int FLOW_RADIUS = (int)(ACTIVE_RANGE / TILE) + 2; // tiles: ventana del flow field alrededor del jugador
+const float ENEMY_CELL = 8.0f * TILE; // celda de la rejilla de enemigos (px)
+const float ENEMY_MAX_HALF = TILE; // cota de la mitad del tamaño de un enemigo (px)
+const std::uint32_t ENEMY_GRAIN = 256; // enemigos por trozo de trabajo en la fase paralela
+const float DAY_LENGTH = 120.0f; // seconds for full day-night cycle
+const float PI = 3.14159265358979323846f;
+const float BASE_BREAK_TIME = 0.6f; // segundos base (ligeramente más rápido)
+// Player health
+const int MAX_HEALTH = 5;
+const float REGEN_INTERVAL = 8.0f; // seconds to recover 1 heart (faster)
+const float REGEN_DELAY_AFTER_DAMAGE = 5.0f; // wait after last damage before regen (faster)
+
+// Vista: 1280x720 con HUD abajo; la cámara se aleja con CAM_ZOOM
+const int VIEW_W_TILES = 40; // 1280 / 32
+const int VIEW_H_TILES = 20; // (720 - HUD) / 32
+const float CAM_ZOOM = 1.40f; // >1 zooms out (shows more) - alejamos la vista un poco más
+
+// Bloques del inventario del HUD (en orden de slot) y del selector (F)
+const std::array<BlockId, 13> HOTBAR = {GRASS,DIRT,STONE,WOOD,LEAF,COAL,IRON,GOLD,SAND,SNOW,NETH,LAVA,WATER};
+
+// Weather system
+enum WeatherMode { WEATHER_NONE = 0, WEATHER_RAIN = 1, WEATHER_SNOW = 2 };
+const float WEATHER_RAIN_SPAWN_PER_SEC = 180.0f; // spawn rate per second per screen
+const float WEATHER_SNOW_SPAWN_PER_SEC = 60.0f;
+// Presupuesto por defecto de cada pool de partículas (clima y efectos); --particles N lo cambia
+const int PARTICLE_BUDGET = 2048;
+const float EFFECT_GRAVITY = 800.0f; // light gravity for sparks and debris
+
+// Entrada de un tick. Los campos "mantenidos" reflejan el estado actual de teclas/ratón;
+// las acciones por flanco se acumulan desde los eventos y se consumen en el siguiente tick.
+struct TickInput {
+    bool left = false, right = false; // A/D o flechas
+    bool mineKey = false;             // X mantenido
+    bool mouseLeft = false;           // botón izquierdo mantenido
+    sf::Vector2f mouseWorld;          // posición del ratón en coordenadas del mundo
+    bool jump = false;                // W/Espacio/Arriba
+    bool placeFacing = false;         // C: colocar en la dirección de mirada
+    bool swing = false;               // F: espadazo
+    bool cycleWeather = false;        // K
+    bool placeAtMouse = false;        // clic derecho sobre (placeX, placeY)
+    int placeX = 0, placeY = 0;
+    int craft = -1;                   // G + clic: receta a fabricar (índice en RECIPES)
+    int selectBlock = -1;             // 1-0, selector o inventario: bloque a seleccionar
+    int selectTool = -1;              // Q/E/R/T: herramienta a seleccionar
+
+    void clear_actions() {
+        jump = placeFacing = swing = cycleWeather = placeAtMouse = false;
+        craft = selectBlock = selectTool = -1;
+    }
+};
+
+// Efecto de un enemigo sobre el resto del juego: se decide en la fase paralela de
+// update_enemies y se aplica después, en orden, en el hilo principal
+struct EnemyEvent {
+    enum Kind : std::uint8_t { TOUCH_PLAYER = 0, EXPLODE } kind;
+    std::uint64_t order; // (tipo, slot): posición del enemigo en el orden de proceso
+    std::uint32_t id;
+};
+
+// Bloque suelto en el suelo (lo que deja una explosión); se recoge al tocarlo
+struct ItemDrop {
+    float x, y, vx, vy;
+    BlockId block;
+    float life;
+};
+
+// Zonas de tiempo de la simulación (ver Profiler.hpp); "respawn" se mide dentro de "enemies"
+enum SimZone { ZONE_PLAYER = 0, ZONE_MINING, ZONE_PATHS, ZONE_ENEMIES, ZONE_BLASTS, ZONE_COMBAT, ZONE_WEATHER, ZONE_EFFECTS, ZONE_BLOCKS, ZONE_LIGHT, ZONE_RESPAWN, SIM_ZONE_COUNT };
+const std::vector<std::string> SIM_ZONE_NAMES = {"player", "mining", "paths", "enemies", "blasts", "combat", "weather", "effects", "blocks", "light", "respawn"};
+// Fases del bucle de la ventana, detrás de las de la simulación (que se miden dentro de "sim")
+enum FrameZone { ZONE_FRAME = SIM_ZONE_COUNT, ZONE_EVENTS, ZONE_SIM, ZONE_STREAM, ZONE_TILES, ZONE_ENTITIES, ZONE_HUD, ZONE_DISPLAY, ZONE_COUNT };
+const std::vector<std::string> FRAME_ZONE_NAMES = {"frame", "events", "sim", "stream", "tiles", "entities", "hud", "display"};
+const std::size_t FRAME_TRACE_EVENTS = 1 << 16;    // F4 vuelca las últimas (varios segundos de juego)
+const std::size_t HEADLESS_TRACE_EVENTS = 1 << 20; // --trace guarda las últimas del run
+const char *PROFILE_TRACE_PATH = "profile_trace.json"; // chrome://tracing o ui.perfetto.dev
+
+struct GameState {
+    World world;
+    Player p{};
+    float spawnPx = 0.0f, spawnPy = 0.0f; // spawn position for respawn on death
+    int playerHealth = MAX_HEALTH;
+    float playerInvuln = 0.0f; // seconds remaining
+    // fall damage / ground tracking
+    bool wasOnGround = true;
+    int lastGroundTile = 0;
+    int fallStartTile = 0;
+    // health regeneration
+    float regenTimer = 0.0f;
+    float timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // seconds since last damage
+    unsigned damageCount = 0; // golpes recibidos; el render reproduce el sonido cuando cambia
+
+    EnemyStore enemies;
+    // Índices derivados de `enemies` (no se guardan; ver rebuild_enemy_index):
+    // rejilla con los vivos por su centro y lista de muertos pendientes de respawn
+    SpatialHash enemyGrid{ENEMY_CELL};
+    std::vector<std::uint32_t> deadEnemies;
+    std::vector<std::uint32_t> enemyScratch; // candidatos de la consulta actual
+    std::vector<std::uint32_t> activeEnemies; // los que se simulan este tick
+    std::vector<std::vector<EnemyEvent>> enemyEvents; // un buffer por hilo del JobSystem
+    FlowField flow; // caminos hacia el jugador para todos los enemigos
+    float swingTimer = 0.0f;
+    float swingActive = 0.0f;
+    float dayTime = 0.0f;
+
+    int weatherMode = WEATHER_NONE;
+    ParticlePool weatherParticles{PARTICLE_BUDGET};
+    float weatherSpawnAcc = 0.0f;
+    ParticlePool effectParticles{PARTICLE_BUDGET}; // chispas y restos de explosiones
+    // Explosiones pendientes de este tick y objetos sueltos (nada de esto se guarda)
+    std::vector<explosion::Blast> blasts;
+    std::vector<ItemDrop> drops;
+    std::vector<TileEdit> blastEdits;  // buffers de update_explosions
+    std::vector<BlockId> blastBroken;
+    LightEngine light; // luz por tile de world (no se guarda: se recalcula al cargar)
+    BlockPhysics blockPhysics; // fluidos y bloques que caen (lo pendiente no se guarda)
+
+    // Picar bloques por tiempo
+    bool breaking = false;
+    int breakX = -1, breakY = -1;
+    float breakProgress = 0.0f;
+    bool prevMouseLeft = false; // for edge detection of left click
+
+    std::uint64_t seed = 0;
+    Rng aiRng;  // decisiones de los enemigos y respawns
+    Rng fxRng;  // partículas (clima, efectos)
+    unsigned long long tick = 0;
+    Profiler *profiler = nullptr; // opcional: tiempos por subsistema
+    JobSystem *jobs = nullptr;    // opcional: hilos para la fase paralela de los enemigos
+};
+
+// Mantiene enemyGrid / deadEnemies al día con el estado del enemigo i
+void index_enemy(GameState &g, std::uint32_t i) {
+    EnemyRef e = g.enemies.ref(i);
+    if (e.alive) g.enemyGrid.update(i, e.x + e.w*0.5f, e.y + e.h*0.5f);
+    else { g.enemyGrid.remove(i); g.deadEnemies.push_back(i); }
+}
+
+void rebuild_enemy_index(GameState &g) {
+    g.enemyGrid.clear();
+    g.deadEnemies.clear();
+    for (std::uint32_t i = 0; i < g.enemies.size(); ++i) index_enemy(g, i);
+}
+
+// Enemigos vivos cuyo rectángulo puede tocar [x0, x1] x [y0, y1], en orden de índice
+const std::vector<std::uint32_t> &enemies_near(GameState &g, float x0, float y0, float x1, float y1) {
+    g.enemyGrid.query_sorted(x0 - ENEMY_MAX_HALF, y0 - ENEMY_MAX_HALF, x1 + ENEMY_MAX_HALF, y1 + ENEMY_MAX_HALF, g.enemyScratch);
+    return g.enemyScratch;
+}
+
+void kill_enemy(GameState &g, std::uint32_t i) {
+    EnemyRef e = g.enemies.ref(i);
+    e.alive = false;
+    e.vx = e.vy = 0.0f;
+    // randomized respawn time
+    e.respawnTimer = ENEMY_RESPAWN_BASE + g.aiRng.next_int((int)ENEMY_RESPAWN_VAR + 1);
+    index_enemy(g, i);
+}
+
+void damage_player(GameState &g) {
+    g.playerHealth = std::max(0, g.playerHealth - 1);
+    g.playerInvuln = 1.0f;
+    g.timeSinceDamage = 0.0f;
+    g.damageCount++;
+}
+
+// Rectángulo que ve la cámara cuando sigue al jugador (sin suavizado), limitado al mapa.
+// La simulación lo usa para generar el clima alrededor del jugador sin depender del render.
+sf::FloatRect sim_view_rect(const GameState &g) {
+    float viewW = (float)VIEW_W_TILES * TILE * CAM_ZOOM;
+    float viewH = (float)VIEW_H_TILES * TILE * CAM_ZOOM;
+    float mapPixelW = (float)g.world.width() * TILE;
+    float mapPixelH = (float)g.world.height() * TILE;
+    float cx = std::min(std::max(g.p.px + g.p.w*0.5f, viewW*0.5f), mapPixelW - viewW*0.5f);
+    float cy = std::min(std::max(g.p.py + g.p.h*0.5f, viewH*0.5f), mapPixelH - viewH*0.5f);
+    return sf::FloatRect(cx - viewW*0.5f, cy - viewH*0.5f, viewW, viewH);
+}
+
+// Crea un enemigo del tipo dado en una cueva cercana a la columna baseX
+bool spawn_enemy(GameState &g, Enemy::Type t, int baseX) {
+    const World &world = g.world;
+    const Player &p = g.p;
+    // spawn only in caves: search for an underground tile near baseX
+    baseX = std::max(1, std::min(world.width()-2, baseX));
+    // find surface height at baseX
+    int surfaceY = std::max(0, world.first_solid_in_col(baseX, 0, world.height() - 1));
+    // search nearby columns for a cave floor (air tile with solid tile below and y > surfaceY + 2)
+    int foundX=-1, foundY=-1;
+    for (int dx=-8; dx<=8 && foundX==-1; ++dx) {
+        int cx = baseX + dx; if (cx < 1 || cx > world.width()-2) continue;
+        int y = world.first_floor_in_col(cx, surfaceY + 3, world.height() - 3);
+        if (y >= 0) { foundX = cx; foundY = y; }
+    }
+    if (foundX == -1) return false; // no cave found nearby
+    Enemy e{};
+    e.type = t; e.w = p.w; e.h = p.h; e.vx = 0; e.vy = 0; e.dir = g.aiRng.next_int(2)?1:-1; e.moveSpeed = 60.0f; e.pauseTimer = 0.0f; e.fuseTimer = 0.0f; e.alive = true;
+    e.x = foundX * TILE; e.y = (foundY - 1) * TILE; // stand on the block above the floor AIR
+    e.prevX = e.x; e.prevY = e.y;
+    e.spawnTileX = foundX; e.spawnTileY = foundY - 1;
+    e.respawnTimer = 0.0f;
+    // set HP by type
+    if (t == Enemy::ZOMBIE) { e.maxHp = 2; }
+    else { e.maxHp = 1; }
+    e.hp = e.maxHp;
+    // tweak per type
+    if (t == Enemy::SPIDER) { e.moveSpeed = 80.0f; }
+    if (t == Enemy::CREEPER) { e.moveSpeed = 30.0f; }
+    if (t == Enemy::SKELETON) { e.moveSpeed = 60.0f; }
+    index_enemy(g, g.enemies.add(e));
+    return true;
+}
+
+void init_game(GameState &g, std::uint64_t seed, int width = W, int height = H, bool streaming = false) {
+    g.seed = seed;
+    g.aiRng = Rng(seed, RNG_AI);
+    g.fxRng = Rng(seed, RNG_EFFECTS);
+    World &world = g.world;
+    Player &p = g.p;
+    init_world(world, seed, width, height, streaming);
+    g.light.reset(world);
+    g.blockPhysics.reset(world);
+
+    p.w = TILE-6; p.h = TILE-6;
+    p.px = (world.width()/2) * TILE; p.vx = 0; p.vy = 0; p.fx = 1; p.fy = 0; p.selected = GRASS;
+    // spawn player above surface at middle column
+    int surface = world.first_solid_in_col(world.width()/2, 0, world.height() - 1);
+    int spawnTileY = surface >= 0 ? surface - 1 : 0;
+    if (spawnTileY < 0) spawnTileY = world.height() - 6;
+    p.py = spawnTileY * TILE;
+    p.prevPx = p.px; p.prevPy = p.py;
+    // store spawn position for respawn on death
+    g.spawnPx = p.px;
+    g.spawnPy = p.py;
+    p.inv = Inventory();
+    p.inv.set(GRASS, 10); p.inv.set(DIRT, 8); p.inv.set(STONE, 6); p.inv.set(WOOD, 3);
+    // make new biome/nether blocks placeable
+    p.inv.set(SAND, 10);
+    p.inv.set(SNOW, 8);
+    p.inv.set(NETH, 2);
+    p.inv.set(LAVA, 1);
+    p.inv.set(WATER, 4);
+    // herramientas iniciales
+    p.inv.set(ITEM_PICKAXE, 1);
+    p.inv.set(ITEM_AXE, 1);
+    p.inv.set(ITEM_SHOVEL, 1);
+    p.inv.set(ITEM_SWORD, 1);
+    p.selectedTool = TOOL_NONE;
+
+    // fall damage / ground tracking
+    g.lastGroundTile = static_cast<int>(std::floor((p.py + p.h) / TILE));
+    g.fallStartTile = g.lastGroundTile;
+
+    // Crear varios enemigos: zombi, esqueleto, araña y creeper
+    int mid = world.width()/2;
+    spawn_enemy(g, Enemy::ZOMBIE, mid + 6);
+    spawn_enemy(g, Enemy::SKELETON, mid - 6);
+    spawn_enemy(g, Enemy::SPIDER, mid + 10);
+    spawn_enemy(g, Enemy::CREEPER, mid - 10);
+}
+
+// Jugador: día/noche, timers del espadazo, acciones de entrada, movimiento y daño por caída
+void update_player(GameState &g, const TickInput &in, float dt) {
+    World &world = g.world;
+    Player &p = g.p;
+    // advance day-night time
+    g.dayTime += dt;
+
+    // update swing timers
+    if (g.swingTimer > 0.0f) g.swingTimer = std::max(0.0f, g.swingTimer - dt);
+    if (g.swingActive > 0.0f) g.swingActive = std::max(0.0f, g.swingActive - dt);
+
+    // acciones por flanco recogidas de los eventos
+    if (in.selectBlock >= 0 && in.selectBlock < BLOCK_COUNT) p.selected = (BlockId)in.selectBlock;
+    if (in.selectTool >= 0 && in.selectTool < TOOL_COUNT) select_tool(p, (Tool)in.selectTool);
+    if (in.placeFacing) {
+        int centerX = static_cast<int>(p.px + p.w/2);
+        int centerY = static_cast<int>(p.py + p.h/2);
+        int tx = (centerX + p.fx * TILE) / TILE;
+        int ty = (centerY + p.fy * TILE) / TILE;
+        BlockId b = p.selected;
+        if (in_bounds(world,tx,ty) && get_block(world,tx,ty)==AIR && p.inv.take(b)){ set_block(world,tx,ty,b); }
+    }
+    if (in.placeAtMouse && in_bounds(world,in.placeX,in.placeY)) {
+        BlockId b = p.selected;
+        if (get_block(world,in.placeX,in.placeY)==AIR && p.inv.take(b)){ set_block(world,in.placeX,in.placeY,b); }
+    }
+    if (in.craft >= 0) p.inv.craft(in.craft);
+    collision::SolidProbe probe(world);
+    if (in.jump) {
+        // Salto: solo si estamos sobre suelo
+        if (collision::grounded(probe, p.px, p.py, p.w, p.h)) { p.vy = -JUMP_SPEED; }
+    }
+    if (in.cycleWeather) {
+        // cycle weather: none -> rain -> snow -> none
+        g.weatherMode = (g.weatherMode + 1) % 3;
+        g.weatherParticles.clear();
+    }
+    if (in.swing) {
+        // sword attack
+        // only swing if sword is selected
+        if (held_tool(p) == TOOL_SWORD) {
+            if (g.swingTimer <= 0.0f) { g.swingTimer = SWING_COOLDOWN; g.swingActive = SWING_ACTIVE; }
         }
     }
-    // bedrock
-    for (int x = 0; x < W; ++x) world[H-1][x] = (char)BEDR;
-
-    // Infierno (nether) en la parte inferior: capas de NETH con bolsas de LAVA encima de la roca profunda
-    int nethDepth = std::max(6, H/12); // number of rows above bedrock for the 'infierno' (larger)
-    for (int y = H-1 - nethDepth; y < H-1; ++y) {
-        for (int x = 0; x < W; ++x) {
-            // no sobreescribir bedrock
-            if (y >= 0 && y < H-1) {
-                // mezclar lava en parches (más lava, más profundo)
-                if ((std::rand() % 100) < 40 && y >= H-2) world[y][x] = (char)LAVA;
-                else world[y][x] = (char)NETH;
-            }
+
+    // Input horizontal
+    float targetVx = 0;
+    if (in.left) { targetVx = -MOVE_SPEED; p.fx = -1; }
+    else if (in.right) { targetVx = MOVE_SPEED; p.fx = 1; }
+    else { targetVx = 0; }
+    p.vx = targetVx;
+
+    // Apply gravity
+    p.vy += GRAVITY * dt;
+    if (p.vy > MAX_FALL_SPEED) p.vy = MAX_FALL_SPEED;
+
+    // Move and resolve collisions (x, then y)
+    collision::Contacts contacts = collision::move_aabb(probe, p.px, p.py, p.vx, p.vy, p.w, p.h, dt);
+
+    // update facing y
+    p.fy = (p.vy > 0) ? 1 : (p.vy < 0 ? -1 : 0);
+
+    // Fall damage detection: check landing and start-fall
+    int belowTileY = collision::tile_of(p.py + p.h + 1);
+    bool onGround = contacts.grounded;
+    if (!g.wasOnGround && onGround) {
+        // landed
+        int landingTile = belowTileY;
+        int dropTiles = landingTile - g.fallStartTile;
+        if (dropTiles >= 5 && g.playerInvuln <= 0.0f) {
+            damage_player(g);
         }
     }
+    if (g.wasOnGround && !onGround) {
+        // started falling: record the ground tile we left
+        g.fallStartTile = g.lastGroundTile;
+    }
+    if (onGround) g.lastGroundTile = belowTileY;
+    g.wasOnGround = onGround;
+}
 
-    // árboles: probabilidad por columna, tronco vertical y copa de hojas (no en desierto, más en snow)
-    for (int x = 2; x < W-2; ++x) {
-        int region = (x * 3) / W;
-        int treeChance = (region == 0) ? 3 : (region == 2 ? 18 : 12); // desert few, snow more
-        if ((std::rand() % 100) < treeChance) {
-            int g = height[x];
-            // avoid trees if desert (surface is sand)
-            if (region == 0) continue;
-            int trunkH = 2 + (std::rand() % 3); // 2..4
-            for (int t = 1; t <= trunkH; ++t) {
-                int ty = g - t;
-                if (ty >= 0) world[ty][x] = (char)WOOD;
+// Picar bloques manteniendo X o el clic izquierdo
+void update_mining(GameState &g, const TickInput &in, float dt) {
+    World &world = g.world;
+    Player &p = g.p;
+    // --- Mecánica de picar por tiempo / ataque con clic izquierdo ---
+    bool keyBreak = in.mineKey;
+    bool curMouseLeft = in.mouseLeft;
+    // if sword is selected, left-click triggers attack on press instead of mining
+    bool mouseBreak = false;
+    if (curMouseLeft) {
+        if (held_tool(p) == TOOL_SWORD) {
+            mouseBreak = false; // do not mine while sword held
+        } else {
+            mouseBreak = true;
+        }
+    }
+    int targetX = -1, targetY = -1;
+    if (keyBreak) {
+        int centerX = static_cast<int>(p.px + p.w/2);
+        int centerY = static_cast<int>(p.py + p.h/2);
+        targetX = (centerX + p.fx * TILE) / TILE;
+        targetY = (centerY + p.fy * TILE) / TILE;
+    } else if (mouseBreak) {
+        sf::Vector2f wp = in.mouseWorld;
+        targetX = static_cast<int>(std::floor(wp.x)) / TILE; targetY = static_cast<int>(std::floor(wp.y)) / TILE;
+    }
+
+    if (targetX != -1 && in_bounds(world,targetX, targetY)) {
+        BlockId tb = get_block(world, targetX, targetY);
+        // dureza del bloque y herramienta en mano (BlockTraits.hpp); < 0 = no se puede picar
+        float mult = break_time_multiplier(tb, held_tool(p));
+        if (mult >= 0.0f) {
+
+            if (g.breaking && g.breakX == targetX && g.breakY == targetY) {
+                g.breakProgress += dt;
+            } else {
+                g.breaking = true;
+                g.breakX = targetX; g.breakY = targetY; g.breakProgress = dt;
             }
-            int topY = g - trunkH;
-            // copa: block of ~5x3
-            for (int dx = -2; dx <= 2; ++dx) for (int dy = -2; dy <= 0; ++dy) {
-                int xx = x + dx; int yy = topY + dy;
-                if (in_bounds(xx, yy) && world[yy][xx] == (char)AIR) {
-                    if (region == 2) world[yy][xx] = (char)SNOW; else world[yy][xx] = (char)LEAF;
-                }
+
+            float need = BASE_BREAK_TIME * mult;
+            if (g.breakProgress >= need) {
+                // completar ruptura
+                p.inv.add(block_traits(tb).drop);
+                set_block(world, g.breakX, g.breakY, AIR);
+                g.breaking = false; g.breakX = g.breakY = -1; g.breakProgress = 0.0f;
             }
+        } else {
+            // objetivo no picable
+            g.breaking = false; g.breakX = g.breakY = -1; g.breakProgress = 0.0f;
         }
+    } else {
+        // no está picando
+        g.breaking = false; g.breakX = g.breakY = -1; g.breakProgress = 0.0f;
     }
+}
 
-    // Crear cuevas/túneles: más largos y profundos, con mayor probabilidad y variación
-    int tunnels = 6 + (std::rand() % 6);
-    for (int i = 0; i < tunnels; ++i) {
-        int tx = std::max(2, std::min(W-3, (std::rand() % W)));
-        // comenzar más profundo para no afectar la capa de superficie
-        int ty = std::min(H-6, height[tx] + 8 + (std::rand() % 6));
-        int len = 40 + (std::rand() % 120); // túneles más largos
-        for (int s = 0; s < len; ++s) {
-            // radio variable (0..2) para cuevas más anchas en partes
-            int radius = (std::rand() % 3);
-            for (int dy = -radius; dy <= radius; ++dy) for (int dx = -radius; dx <= radius; ++dx) {
-                int xx = tx + dx; int yy = ty + dy;
-                // no cavar en la capa superior cercana (proteger altura de columna)
-                if (in_bounds(xx, yy) && yy < H-2 && yy > height[tx] + 2) world[yy][xx] = (char)AIR;
-            }
-            // random walk con mayor variación vertical y sesgo horizontal
-            tx += (std::rand() % 5) - 2;
-            ty += (std::rand() % 5) - 2;
-            if (tx < 1) tx = 1; if (tx > W-2) tx = W-2;
-            if (ty < 2) ty = 2; if (ty > H-3) ty = H-3;
+// Tirada en [0, n) para la IA del enemigo `id` en este tick. No tiene estado: no
+// depende del orden en que se procesen los enemigos ni del hilo que lo haga.
+int ai_roll(const GameState &g, std::uint32_t id, int n) {
+    return (int)(coord_hash(g.seed, RNG_AI, id, (std::int64_t)g.tick) % (std::uint64_t)n);
+}
+
+// Perseguir al jugador: la dirección sale del flow field en la celda de los pies
+// (saltando si el camino sube); sin camino, en línea recta como antes
+void chase_player(const GameState &g, collision::SolidProbe &probe, const EnemyRef &e, float dxE) {
+    int dir = 0;
+    bool jump = false;
+    if (g.flow.sample(collision::tile_of(e.x + e.w*0.5f), collision::tile_of(e.y + e.h - 1), dir, jump) && dir != 0) {
+        e.vx = e.moveSpeed * dir;
+        if (jump && e.vy >= 0.0f && collision::grounded(probe, e.x, e.y, e.w, e.h)) e.vy = -JUMP_SPEED;
+    } else {
+        e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed;
+    }
+}
+
+// Comportamiento de cada tipo de enemigo; solo se llama si no está en pausa.
+// dxE: distancia horizontal con signo del enemigo al jugador (centro a centro).
+// Corren en la fase paralela: solo leen el mundo y el jugador y solo escriben en
+// el propio enemigo; lo demás se pide con un EnemyEvent.
+void walker_ai(const GameState &g, collision::SolidProbe &probe, const EnemyRef &e, std::uint32_t id, float dxE) {
+    float distE = std::abs(dxE);
+    if (distE < 500.0f) chase_player(g, probe, e, dxE);
+    else { e.vx = e.moveSpeed * e.dir; if (ai_roll(g, id, 1000) < 8) { e.dir = -e.dir; e.pauseTimer = 0.35f; e.vx = 0.0f; } }
+}
+
+void spider_ai(const GameState &g, collision::SolidProbe &probe, const EnemyRef &e, std::uint32_t id, float dxE) {
+    float distE = std::abs(dxE);
+    // spider: can jump higher towards player
+    bool onGround = collision::grounded(probe, e.x, e.y, e.w, e.h);
+    if (distE < 500.0f) chase_player(g, probe, e, dxE);
+    else e.vx = e.moveSpeed * e.dir;
+    if (onGround && distE < 250.0f && ai_roll(g, id, 100) < 25) { e.vy = -JUMP_SPEED * 1.15f; }
+}
+
+// Devuelve true si la mecha llegó a 0 (la explosión la aplica explode_creeper)
+bool creeper_ai(const GameState &g, collision::SolidProbe &probe, const EnemyRef &e, float dxE, float dt) {
+    float distE = std::abs(dxE);
+    bool explode = false;
+    // creeper: slow approach, when close start fuse and explode
+    const float triggerDist = 160.0f;
+    if (distE < triggerDist && e.fuseTimer <= 0.0f) { e.fuseTimer = 1.6f; }
+    if (e.fuseTimer > 0.0f) { e.fuseTimer -= dt; if (e.fuseTimer <= 0.0f) explode = true; }
+    // approach slowly while not fusing
+    if (e.fuseTimer <= 0.0f) {
+        if (distE < 500.0f) chase_player(g, probe, e, dxE); else e.vx = e.moveSpeed * e.dir;
+    } else e.vx = 0.0f; // fuse pause movement
+    return explode;
+}
+
+// El creeper `id` explota: muere y su explosión queda encolada para update_explosions
+void explode_creeper(GameState &g, std::uint32_t id) {
+    EnemyRef e = g.enemies.ref(id);
+    g.blasts.push_back(explosion::Blast{e.x + e.w*0.5f, e.y + e.h*0.5f, EXPLOSION_RADIUS, EXPLOSION_POWER});
+    kill_enemy(g, id);
+}
+
+// Aplica las explosiones encoladas en este tick, en orden. Los creepers que alcanza
+// una explosión explotan en la misma pasada (reacción en cadena: se añaden al final
+// de la lista); el resto de enemigos y el jugador reciben daño. Después se rompen
+// los tiles de todas a la vez (un solo World::set_batch) y parte de los bloques
+// rotos quedan como objetos sueltos.
+void update_explosions(GameState &g) {
+    if (g.blasts.empty()) return;
+    Player &p = g.p;
+    float pcx = p.px + p.w*0.5f, pcy = p.py + p.h*0.5f;
+    for (std::size_t i = 0; i < g.blasts.size(); ++i) {
+        explosion::Blast b = g.blasts[i]; // copia: explode_creeper añade a g.blasts
+        // partículas de la explosión
+        for (int pi = 0; pi < 20; ++pi) {
+            // el RNG se consume igual aunque el pool esté lleno: la simulación no depende del presupuesto
+            float vx = (g.fxRng.next_int(200) - 100) * 3.0f; float vy = (g.fxRng.next_int(200) - 200) * 3.0f;
+            float life = 0.8f + g.fxRng.next_int(100)/200.0f; float size = 2.0f + g.fxRng.next_int(6);
+            g.effectParticles.spawn(b.x, b.y, vx, vy, life, size*2.0f, size*2.0f, (pi%2==0) ? sf::Color(255,180,60) : sf::Color(180,80,40));
+        }
+        if (std::hypot(pcx - b.x, pcy - b.y) < b.radius && g.playerInvuln <= 0.0f) damage_player(g);
+        std::vector<std::uint32_t> hit = enemies_near(g, b.x - b.radius, b.y - b.radius, b.x + b.radius, b.y + b.radius);
+        for (std::uint32_t o : hit) {
+            EnemyRef other = g.enemies.ref(o);
+            if (!other.alive || std::hypot(other.x + other.w*0.5f - b.x, other.y + other.h*0.5f - b.y) >= b.radius) continue;
+            if (other.type == Enemy::CREEPER) { explode_creeper(g, o); continue; }
+            other.hp -= EXPLOSION_DAMAGE;
+            if (other.hp <= 0) kill_enemy(g, o);
         }
     }
+    explosion::footprint(g.world, g.blasts, g.blastEdits, g.blastBroken);
+    // objetos sueltos: qué bloques caen sale de un hash de la posición y el tick
+    for (std::size_t k = 0; k < g.blastEdits.size() && g.drops.size() < MAX_DROPS; ++k) {
+        BlockId d = block_traits(g.blastBroken[k]).drop;
+        const TileEdit &t = g.blastEdits[k];
+        std::uint64_t h = coord_hash(g.seed, RNG_EFFECTS, t.x, ((std::int64_t)g.tick << 16) ^ t.y);
+        if (d == AIR || h % 100 >= (std::uint64_t)DROP_CHANCE) continue;
+        float vx = (float)((int)((h >> 8) % 200) - 100);
+        float vy = -150.0f - (float)((h >> 16) % 150);
+        g.drops.push_back(ItemDrop{t.x * TILE + (TILE - DROP_SIZE) * 0.5f, t.y * TILE + (TILE - DROP_SIZE) * 0.5f, vx, vy, d, DROP_LIFE});
+    }
+    g.world.set_batch(g.blastEdits);
+    g.blasts.clear();
+}
 
-    // Generar vetas de mineral: reemplazar algo de piedra por carbón/hierro/oro según profundidad
-    for (int y = 2; y < H-2; ++y) {
-        for (int x = 1; x < W-1; ++x) {
-            if (world[y][x] == (char)STONE) {
-                int depth = y;
-                int r = std::rand() % 1000;
-                // carbón: más frecuente en capas superiores de roca
-                if (r < 40 && depth < H/2) world[y][x] = (char)COAL; // ~4%
-                // hierro: menos frecuente y más profundo
-                else if (r < 52 && depth >= H/4 && depth < (3*H)/4) world[y][x] = (char)IRON; // ~1.2%
-                // oro: raro, profundo
-                else if (r < 55 && depth > (3*H)/4) world[y][x] = (char)GOLD; // ~0.3%
+// ¿El enemigo del slot s toca al jugador?
+bool touches_player(const Player &p, const EnemyArchetype &a, std::uint32_t s) {
+    float ax1 = a.x[s], ay1 = a.y[s], ax2 = a.x[s] + a.w[s], ay2 = a.y[s] + a.h[s];
+    float bx1 = p.px, by1 = p.py, bx2 = p.px + p.w, by2 = p.py + p.h;
+    return (ax1 < bx2 && ax2 > bx1 && ay1 < by2 && ay2 > by1);
+}
+
+// Respawn de un muerto cuya cuenta atrás llegó a 0 (improved): postpone if player
+// nearby and choose safe nearby spot
+void try_respawn(GameState &g, const EnemyRef &e, std::uint32_t id) {
+    World &world = g.world;
+    Player &p = g.p;
+    // avoid respawn if player is very close to spawn
+    float spawnCx = e.spawnTileX * TILE + TILE*0.5f;
+    float spawnCy = e.spawnTileY * TILE + TILE*0.5f;
+    float pxCenter = p.px + p.w*0.5f; float pyCenter = p.py + p.h*0.5f;
+    float pdist = std::hypot(pxCenter - spawnCx, pyCenter - spawnCy);
+    if (pdist < 5.0f * TILE) {
+        // push respawn a bit further
+        e.respawnTimer = 2.0f + g.aiRng.next_int(3);
+        return;
+    }
+    bool placed = false;
+    // search for a nearby suitable tile (air with solid below)
+    for (int r = 0; r <= 6 && !placed; ++r) {
+        for (int dx = -r; dx <= r && !placed; ++dx) for (int dy = -r; dy <= r && !placed; ++dy) {
+            int tx = e.spawnTileX + dx; int ty = e.spawnTileY + dy;
+            if (!in_bounds(world,tx, ty)) continue;
+            if (get_block(world, tx, ty) == AIR && isSolid(get_block(world, tx, ty+1))) {
+                e.x = tx * TILE; e.y = ty * TILE; placed = true; break;
             }
         }
     }
+    // fallback: respawn at exact spawn tile
+    if (!placed) { e.x = e.spawnTileX * TILE; e.y = e.spawnTileY * TILE; }
+    e.alive = true; e.hp = e.maxHp; e.vx = 0.0f; e.vy = 0.0f; e.fuseTimer = 0.0f; e.pauseTimer = 0.8f; e.prevX = e.x; e.prevY = e.y;
+    index_enemy(g, id);
 }
 
-// Helpers para detección de colisiones AABB -> tiles
-void resolveHorizontal(World &world, Player &p, float newPx) {
-    float left = newPx;
-    float right = newPx + p.w - 1;
-    int topTile = std::floor(p.py / TILE);
-    int bottomTile = std::floor((p.py + p.h - 1) / TILE);
-    int leftTile = std::floor(left / TILE);
-    int rightTile = std::floor(right / TILE);
-    if (p.vx > 0) {
-        for (int tx = rightTile; tx <= rightTile; ++tx) {
-            for (int ty = topTile; ty <= bottomTile; ++ty) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    p.px = tx * TILE - p.w; p.vx = 0; return;
-                }
+// IA, física y respawn de enemigos
+void update_enemies(GameState &g, float dt) {
+    Player &p = g.p;
+    auto &enemies = g.enemies;
+    // los que revivieron salen de la lista de muertos (y cada muerto queda una sola vez)
+    auto &dead = g.deadEnemies;
+    dead.erase(std::remove_if(dead.begin(), dead.end(), [&](std::uint32_t i) { return enemies.alive(i); }), dead.end());
+    std::sort(dead.begin(), dead.end());
+    dead.erase(std::unique(dead.begin(), dead.end()), dead.end());
+    // Solo se procesan los vivos cerca del jugador (consulta a la rejilla) y los
+    // muertos pendientes de respawn: el coste depende de los enemigos cercanos y
+    // no del total. Los vivos a menos de ACTIVE_RANGE se simulan; el resto de
+    // candidatos solo actualiza su posición anterior.
+    // (la consulta va sin ordenar: el orden de la rejilla ya es determinista)
+    float pcx = p.px + p.w*0.5f, pcy = p.py + p.h*0.5f;
+    const float range = ACTIVE_RANGE + ENEMY_MAX_HALF;
+    auto &active = g.activeEnemies;
+    active.clear();
+    g.enemyGrid.query(pcx - range, pcy - range, pcx + range, pcy + range, [&](std::uint32_t id) {
+        EnemyRef e = enemies.ref(id);
+        float dx = pcx - (e.x + e.w*0.5f), dy = pcy - (e.y + e.h*0.5f);
+        if (dx*dx + dy*dy < ACTIVE_RANGE * ACTIVE_RANGE) active.push_back(id);
+        else { e.prevX = e.x; e.prevY = e.y; }
+    });
+    // Simulados y muertos se agrupan al principio de su arquetipo; los kernels por
+    // lotes hacen la parte común a todos los tipos (posición anterior, pausa,
+    // gravedad, cuenta atrás del respawn) antes de la IA de cada tipo. El orden
+    // (tipo, slot) solo depende de la historia de la partida, así que la
+    // simulación sigue siendo determinista.
+    enemies.partition(active, dead);
+    for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) {
+        EnemyArchetype &a = enemies.archetype(t);
+        enemy_kernels::begin_tick(a, dt, GRAVITY * dt, MAX_FALL_SPEED);
+        enemy_kernels::dead_tick(a, dt);
+    }
+    // Fase paralela: IA y movimiento de todos los simulados, repartidos entre los
+    // hilos del JobSystem como un solo rango (los arquetipos uno detrás de otro).
+    // El mundo y el jugador no cambian durante la fase y cada enemigo solo escribe
+    // en su slot; las explosiones y el daño al jugador se anotan en el buffer del
+    // hilo y se aplican después en el orden (tipo, slot), sea cual sea el hilo
+    // que procesó cada enemigo.
+    std::uint32_t first[ENEMY_TYPE_COUNT + 1] = {0};
+    for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) first[t + 1] = first[t] + enemies.archetype(t).active;
+    g.enemyEvents.resize(g.jobs ? g.jobs->thread_count() : 1);
+    // Cada trozo se hace por tramos de un arquetipo: IA, colisión del tramo en lote
+    // y contacto con el jugador.
+    auto simulate = [&g, &enemies, &first, pcx, dt](std::uint32_t begin, std::uint32_t end, int thread) {
+        auto &events = g.enemyEvents[thread];
+        collision::SolidProbe probe(g.world);
+        for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) {
+            std::uint32_t s0 = std::max(begin, first[t]) - first[t];
+            std::uint32_t s1 = std::min(end, first[t + 1]);
+            if (s1 <= first[t] + s0) continue;
+            s1 -= first[t];
+            EnemyArchetype &a = enemies.archetype(t);
+            for (std::uint32_t s = s0; s < s1; ++s) {
+                // en pausa: begin_tick ya la descontó y paró al enemigo
+                if (a.paused[s]) continue;
+                EnemyRef e = enemies.slot_ref(t, s);
+                std::uint32_t id = a.id[s];
+                float dxE = pcx - (e.x + e.w*0.5f);
+                if (t == Enemy::SPIDER) spider_ai(g, probe, e, id, dxE);
+                else if (t == Enemy::CREEPER) { if (creeper_ai(g, probe, e, dxE, dt)) events.push_back(EnemyEvent{EnemyEvent::EXPLODE, ((std::uint64_t)t << 32) | s, id}); }
+                else walker_ai(g, probe, e, id, dxE);
             }
+            collision::move_batch(probe, a, s0, s1, dt);
+            // collision damage to player (creeper handled on explosion)
+            if (t == Enemy::CREEPER) continue;
+            for (std::uint32_t s = s0; s < s1; ++s)
+                if (touches_player(g.p, a, s)) events.push_back(EnemyEvent{EnemyEvent::TOUCH_PLAYER, ((std::uint64_t)t << 32) | s, a.id[s]});
         }
-    } else if (p.vx < 0) {
-        for (int tx = leftTile; tx >= leftTile; --tx) {
-            for (int ty = topTile; ty <= bottomTile; ++ty) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    p.px = (tx+1) * TILE; p.vx = 0; return;
-                }
-            }
+    };
+    if (g.jobs) g.jobs->parallel_for(first[ENEMY_TYPE_COUNT], ENEMY_GRAIN, simulate);
+    else simulate(0, first[ENEMY_TYPE_COUNT], 0);
+
+    // Fase en serie: rejilla, efectos anotados y respawns
+    for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) {
+        EnemyArchetype &a = enemies.archetype(t);
+        for (std::uint32_t s = 0; s < a.active; ++s) index_enemy(g, a.id[s]);
+    }
+    std::vector<EnemyEvent> events;
+    for (auto &buf : g.enemyEvents) { events.insert(events.end(), buf.begin(), buf.end()); buf.clear(); }
+    std::sort(events.begin(), events.end(), [](const EnemyEvent &x, const EnemyEvent &y) {
+        return x.order != y.order ? x.order < y.order : x.kind < y.kind;
+    });
+    for (const EnemyEvent &ev : events) {
+        if (!enemies.alive(ev.id)) continue;
+        if (ev.kind == EnemyEvent::EXPLODE) explode_creeper(g, ev.id);
+        else if (g.playerInvuln <= 0.0f) damage_player(g);
+    }
+    ProfileScope ps(g.profiler, ZONE_RESPAWN);
+    for (int t = 0; t < ENEMY_TYPE_COUNT; ++t) {
+        EnemyArchetype &a = enemies.archetype(t);
+        for (std::uint32_t s = a.active; s < a.active + a.dead; ++s) {
+            if (!a.alive[s] && a.respawnTimer[s] <= 0.0f) try_respawn(g, enemies.slot_ref(t, s), a.id[s]);
         }
     }
-    p.px = newPx;
 }
 
-void resolveVertical(World &world, Player &p, float newPy) {
-    float top = newPy;
-    float bottom = newPy + p.h - 1;
-    int leftTile = std::floor(p.px / TILE);
-    int rightTile = std::floor((p.px + p.w - 1) / TILE);
-    int topTile = std::floor(top / TILE);
-    int bottomTile = std::floor(bottom / TILE);
-    if (p.vy > 0) { // falling
-        for (int ty = bottomTile; ty <= bottomTile; ++ty) {
-            for (int tx = leftTile; tx <= rightTile; ++tx) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    p.py = ty * TILE - p.h; p.vy = 0; return;
+// Golpes de espada y disparo del espadazo con clic izquierdo
+void update_combat(GameState &g, const TickInput &in) {
+    Player &p = g.p;
+    auto &enemies = g.enemies;
+    // Sword hit detection while g.swingActive > 0
+    if (g.swingActive > 0.0f) {
+        float attackX = (p.fx >= 0) ? (p.px + p.w) : (p.px - SWING_RANGE);
+        float attackY = p.py;
+        float attackW = SWING_RANGE;
+        float attackH = p.h;
+        for (std::uint32_t id : enemies_near(g, attackX, attackY, attackX + attackW, attackY + attackH)) {
+            EnemyRef e = enemies.ref(id);
+            float ax1 = attackX, ay1 = attackY, ax2 = attackX + attackW, ay2 = attackY + attackH;
+            float bx1 = e.x, by1 = e.y, bx2 = e.x + e.w, by2 = e.y + e.h;
+            bool hit = (ax1 < bx2 && ax2 > bx1 && ay1 < by2 && ay2 > by1);
+            if (hit) {
+                // only damage if sword is selected
+                if (held_tool(p) == TOOL_SWORD) {
+                    e.hp -= SWORD_DAMAGE;
+                    // spawn hit sparks
+                    for (int si = 0; si < 6; ++si) {
+                        float vx = (g.fxRng.next_int(200) - 100) * 2.0f; float vy = (g.fxRng.next_int(200) - 200) * 2.0f;
+                        float life = 0.25f + g.fxRng.next_int(100)/400.0f; float size = 1.0f + g.fxRng.next_int(3);
+                        g.effectParticles.spawn(e.x + e.w*0.5f, e.y + e.h*0.5f, vx, vy, life, size*2.0f, size*2.0f, sf::Color(255,220,160));
+                    }
+                    if (e.hp <= 0) kill_enemy(g, id);
                 }
             }
         }
-    } else if (p.vy < 0) { // rising
-        for (int ty = topTile; ty >= topTile; --ty) {
-            for (int tx = leftTile; tx <= rightTile; ++tx) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    p.py = (ty+1) * TILE; p.vy = 0; return;
-                }
-            }
+    }
+
+    // handle left-click attack trigger (edge): if pressed this frame and sword selected, trigger swing
+    bool curMouseLeftForEdge = in.mouseLeft;
+    if (curMouseLeftForEdge && !g.prevMouseLeft) {
+        if (held_tool(p) == TOOL_SWORD) {
+            if (g.swingTimer <= 0.0f) { g.swingTimer = SWING_COOLDOWN; g.swingActive = SWING_ACTIVE; }
         }
     }
-    p.py = newPy;
+    g.prevMouseLeft = curMouseLeftForEdge;
 }
 
-// Enemy simple con tipos: ZOMBIE, SKELETON, SPIDER, CREEPER
-struct Enemy {
-    enum Type { ZOMBIE=0, SKELETON=1, SPIDER=2, CREEPER=3 } type;
-    float x, y;
-    float vx, vy;
-    float w, h;
-    int dir; // dirección horizontal preferida (-1 o 1)
-    float moveSpeed;
-    float pauseTimer; // tiempo de pausa para comportamiento torpe
-    // creeper-specific
-    float fuseTimer; // >0 means about to explode
-    bool alive;
-    int hp; // health points
-    int maxHp;
-    float respawnTimer; // seconds until respawn when dead
-    int spawnTileX, spawnTileY; // where to respawn (tile coords)
-};
+// Invulnerabilidad, regeneración y muerte del jugador
+void update_player_status(GameState &g, float dt) {
+    Player &p = g.p;
+    // actualizar invulnerabilidad del jugador
+    if (g.playerInvuln > 0.0f) g.playerInvuln = std::max(0.0f, g.playerInvuln - dt);
+    // actualizar timers de regeneración
+    g.timeSinceDamage += dt;
+    if (g.timeSinceDamage >= REGEN_DELAY_AFTER_DAMAGE) {
+        g.regenTimer += dt;
+        if (g.regenTimer >= REGEN_INTERVAL) {
+            if (g.playerHealth < MAX_HEALTH) g.playerHealth++;
+            g.regenTimer = 0.0f;
+        }
+    } else {
+        g.regenTimer = 0.0f;
+    }
 
-void resolveHorizontalEnemy(World &world, Enemy &e, float newX) {
-    float left = newX;
-    float right = newX + e.w - 1;
-    int topTile = std::floor(e.y / TILE);
-    int bottomTile = std::floor((e.y + e.h - 1) / TILE);
-    int leftTile = std::floor(left / TILE);
-    int rightTile = std::floor(right / TILE);
-    if (e.vx > 0) {
-        for (int tx = rightTile; tx <= rightTile; ++tx) {
-            for (int ty = topTile; ty <= bottomTile; ++ty) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    e.x = tx * TILE - e.w; e.vx = 0; return;
-                }
+    // Death / respawn
+    if (g.playerHealth <= 0) {
+        // respawn at initial spawn
+        p.px = g.spawnPx; p.py = g.spawnPy; p.vx = 0.0f; p.vy = 0.0f;
+        p.prevPx = p.px; p.prevPy = p.py; // teletransporte: no interpolar desde la posición de muerte
+        g.playerHealth = MAX_HEALTH;
+        g.playerInvuln = 1.0f;
+        g.timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // delay regen after death
+        // reset fall tracking
+        g.wasOnGround = true;
+        g.lastGroundTile = static_cast<int>(std::floor((p.py + p.h) / TILE));
+        g.fallStartTile = g.lastGroundTile;
+    }
+}
+
+// Partículas de clima alrededor de la vista del jugador
+void update_weather(GameState &g, float dt) {
+    // Weather particles: spawn and update (in world coordinates, alrededor de la vista del jugador)
+    {
+        sf::FloatRect view = sim_view_rect(g);
+        float left = view.left; float top = view.top;
+        float bottom = top + view.height;
+        // spawn accumulator
+        if (g.weatherMode == WEATHER_RAIN) {
+            g.weatherSpawnAcc += dt * WEATHER_RAIN_SPAWN_PER_SEC;
+            while (g.weatherSpawnAcc >= 1.0f) {
+                g.weatherSpawnAcc -= 1.0f;
+                float x = left + g.fxRng.next_int((int)view.width); float vy = 700.0f + g.fxRng.next_int(300);
+                g.weatherParticles.spawn(x, top - 10.0f, 0.0f, vy, (bottom - top) / vy + 1.0f, 2.0f, 10.0f, sf::Color(160,200,255,200));
             }
-        }
-    } else if (e.vx < 0) {
-        for (int tx = leftTile; tx >= leftTile; --tx) {
-            for (int ty = topTile; ty <= bottomTile; ++ty) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    e.x = (tx+1) * TILE; e.vx = 0; return;
-                }
+        } else if (g.weatherMode == WEATHER_SNOW) {
+            g.weatherSpawnAcc += dt * WEATHER_SNOW_SPAWN_PER_SEC;
+            while (g.weatherSpawnAcc >= 1.0f) {
+                g.weatherSpawnAcc -= 1.0f;
+                float x = left + g.fxRng.next_int((int)view.width); float vy = 60.0f + g.fxRng.next_int(100);
+                g.weatherParticles.spawn(x, top - 10.0f, 0.0f, vy, (bottom - top) / vy + 2.0f, 4.0f, 4.0f, sf::Color(240,240,255,220));
             }
+        } else {
+            // no spawn
         }
+        // update particles (caen a velocidad constante; fuera al salir por abajo)
+        g.weatherParticles.update(dt, 0.0f, bottom + 20.0f);
     }
-    e.x = newX;
 }
 
-void resolveVerticalEnemy(World &world, Enemy &e, float newY) {
-    float top = newY;
-    float bottom = newY + e.h - 1;
-    int leftTile = std::floor(e.x / TILE);
-    int rightTile = std::floor((e.x + e.w - 1) / TILE);
-    int topTile = std::floor(top / TILE);
-    int bottomTile = std::floor(bottom / TILE);
-    if (e.vy > 0) { // falling
-        for (int ty = bottomTile; ty <= bottomTile; ++ty) {
-            for (int tx = leftTile; tx <= rightTile; ++tx) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    e.y = ty * TILE - e.h; e.vy = 0; return;
-                }
-            }
+// Partículas de efectos (chispas, restos de explosiones) y objetos sueltos: caen con
+// colisión y el jugador los recoge al tocarlos
+void update_effects(GameState &g, float dt) {
+    g.effectParticles.update(dt, EFFECT_GRAVITY);
+    if (g.drops.empty()) return;
+    collision::SolidProbe probe(g.world);
+    const Player &p = g.p;
+    for (std::size_t i = 0; i < g.drops.size();) {
+        ItemDrop &d = g.drops[i];
+        d.vy = std::min(d.vy + GRAVITY * dt, MAX_FALL_SPEED);
+        if (collision::move_aabb(probe, d.x, d.y, d.vx, d.vy, DROP_SIZE, DROP_SIZE, dt).grounded) d.vx = 0.0f;
+        d.life -= dt;
+        bool picked = d.x < p.px + p.w && d.x + DROP_SIZE > p.px && d.y < p.py + p.h && d.y + DROP_SIZE > p.py;
+        if (picked) g.p.inv.add(d.block);
+        if (picked || d.life <= 0.0f) { d = g.drops.back(); g.drops.pop_back(); }
+        else ++i;
+    }
+}
+
+// Avanza la simulación un paso fijo `dt` (no depende de la ventana ni del audio)
+void sim_tick(GameState &g, const TickInput &in, float dt) {
+    g.tick++;
+    // guardar posiciones del tick anterior para interpolar el render
+    g.p.prevPx = g.p.px; g.p.prevPy = g.p.py;
+    // (los enemigos guardan su posición anterior en update_enemies, solo los que se simulan)
+
+    { ProfileScope ps(g.profiler, ZONE_PLAYER); update_player(g, in, dt); }
+    { ProfileScope ps(g.profiler, ZONE_MINING); update_mining(g, in, dt); }
+    {
+        // flow field hacia la celda de pie del jugador (solo se rehace si cambió esa celda o la ventana)
+        ProfileScope ps(g.profiler, ZONE_PATHS);
+        g.flow.update(g.world, collision::tile_of(g.p.px + g.p.w*0.5f), collision::tile_of(g.p.py + g.p.h - 1), FLOW_RADIUS);
+    }
+    { ProfileScope ps(g.profiler, ZONE_ENEMIES); update_enemies(g, dt); }
+    { ProfileScope ps(g.profiler, ZONE_BLASTS); update_explosions(g); }
+    { ProfileScope ps(g.profiler, ZONE_COMBAT); update_combat(g, in); }
+    { ProfileScope ps(g.profiler, ZONE_PLAYER); update_player_status(g, dt); }
+    { ProfileScope ps(g.profiler, ZONE_WEATHER); update_weather(g, dt); }
+    { ProfileScope ps(g.profiler, ZONE_EFFECTS); update_effects(g, dt); }
+    { ProfileScope ps(g.profiler, ZONE_BLOCKS); g.blockPhysics.update(g.world, g.tick); }
+    // luz: solo alrededor de los bloques que cambiaron en este tick
+    { ProfileScope ps(g.profiler, ZONE_LIGHT); g.light.update(g.world); }
+}
+
+// ---------------------------------------------------------------------------
+// Guardado / carga de partida (formato binario, ver SaveFormat.hpp y Autosave.hpp).
+// Archivo = cabecera (semilla, tick) + mundo por chunks + estado del juego: jugador,
+// enemigos, día y clima. Las partículas no se guardan.
+const char *DEFAULT_SAVE_PATH = "saves/world.mc2d";
+
+save::Header save_header(const GameState &g) {
+    save::Header h;
+    h.seed = g.seed;
+    h.tick = g.tick;
+    return h;
+}
+
+// Estado del juego sin el mundo (lo que acompaña a cada registro del autoguardado)
+std::vector<std::uint8_t> save_meta(const GameState &g) {
+    ByteWriter out;
+    const Player &p = g.p;
+    out.f32(p.px); out.f32(p.py); out.f32(p.vx); out.f32(p.vy);
+    out.i32(p.fx); out.i32(p.fy);
+    out.u8((std::uint8_t)p.selected);
+    // bloques por id y herramientas por nombre (el formato de antes del registro de objetos)
+    out.u32((std::uint32_t)BLOCK_COUNT);
+    for (int b = 0; b < BLOCK_COUNT; ++b) { out.u8((std::uint8_t)b); out.i32(p.inv.count((ItemId)b)); }
+    out.u32((std::uint32_t)(TOOL_COUNT - TOOL_PICKAXE));
+    for (int t = TOOL_PICKAXE; t < TOOL_COUNT; ++t) { out.str(TOOL_INFO[t].id); out.i32(p.inv.count(tool_item((Tool)t))); }
+    out.str(TOOL_INFO[p.selectedTool].id);
+    out.f32(g.spawnPx); out.f32(g.spawnPy);
+    out.i32(g.playerHealth); out.f32(g.playerInvuln);
+    out.u8(g.wasOnGround ? 1 : 0); out.i32(g.lastGroundTile); out.i32(g.fallStartTile);
+    out.f32(g.regenTimer); out.f32(g.timeSinceDamage);
+
+    out.u32(g.enemies.size());
+    for (std::uint32_t id = 0; id < g.enemies.size(); ++id) {
+        Enemy e = g.enemies.get(id);
+        out.u8((std::uint8_t)e.type);
+        out.f32(e.x); out.f32(e.y); out.f32(e.vx); out.f32(e.vy); out.f32(e.w); out.f32(e.h);
+        out.i32(e.dir); out.f32(e.moveSpeed); out.f32(e.pauseTimer); out.f32(e.fuseTimer);
+        out.u8(e.alive ? 1 : 0); out.i32(e.hp); out.i32(e.maxHp); out.f32(e.respawnTimer);
+        out.i32(e.spawnTileX); out.i32(e.spawnTileY);
+    }
+    out.f32(g.swingTimer); out.f32(g.swingActive);
+    out.f32(g.dayTime);
+    out.i32(g.weatherMode);
+    return std::move(out.data());
+}
+
+bool load_meta(GameState &n, ByteReader &in) {
+    Player &p = n.p;
+    p.px = in.f32(); p.py = in.f32(); p.vx = in.f32(); p.vy = in.f32();
+    p.fx = in.i32(); p.fy = in.i32();
+    p.selected = in.u8();
+    if (p.selected >= BLOCK_COUNT) return false;
+    std::uint32_t invCount = in.u32();
+    for (std::uint32_t i = 0; i < invCount && in.ok; ++i) {
+        BlockId b = in.u8();
+        if (b >= BLOCK_COUNT) return false;
+        p.inv.set(b, in.i32());
+    }
+    std::uint32_t toolCount = in.u32();
+    for (std::uint32_t i = 0; i < toolCount && in.ok; ++i) {
+        Tool t = tool_from_id(in.str());
+        int n = in.i32();
+        if (t != TOOL_NONE) p.inv.set(tool_item(t), n); // herramientas desconocidas se ignoran
+    }
+    p.selectedTool = tool_from_id(in.str());
+    p.w = TILE-6; p.h = TILE-6;
+    p.prevPx = p.px; p.prevPy = p.py;
+    n.spawnPx = in.f32(); n.spawnPy = in.f32();
+    n.playerHealth = in.i32(); n.playerInvuln = in.f32();
+    n.wasOnGround = in.u8() != 0; n.lastGroundTile = in.i32(); n.fallStartTile = in.i32();
+    n.regenTimer = in.f32(); n.timeSinceDamage = in.f32();
+
+    std::uint32_t enemyCount = in.u32();
+    for (std::uint32_t i = 0; i < enemyCount && in.ok; ++i) {
+        Enemy e{};
+        e.type = (Enemy::Type)(in.u8() & 3);
+        e.x = in.f32(); e.y = in.f32(); e.vx = in.f32(); e.vy = in.f32(); e.w = in.f32(); e.h = in.f32();
+        e.dir = in.i32(); e.moveSpeed = in.f32(); e.pauseTimer = in.f32(); e.fuseTimer = in.f32();
+        e.alive = in.u8() != 0; e.hp = in.i32(); e.maxHp = in.i32(); e.respawnTimer = in.f32();
+        e.spawnTileX = in.i32(); e.spawnTileY = in.i32();
+        e.prevX = e.x; e.prevY = e.y;
+        n.enemies.add(e);
+    }
+    rebuild_enemy_index(n);
+    n.swingTimer = in.f32(); n.swingActive = in.f32();
+    n.dayTime = in.f32();
+    n.weatherMode = in.i32();
+    return in.ok;
+}
+
+// Guardado completo y síncrono (headless --save); descarta el journal que hubiera
+bool save_game(const GameState &g, const std::string &path) {
+    ByteWriter out;
+    journal::write_base(out, save_header(g), g.world, save_meta(g));
+    std::error_code ec;
+    auto dir = std::filesystem::path(path).parent_path();
+    if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+    if (!journal::write_file_atomic(path, out)) return false;
+    std::filesystem::remove(journal::journal_path(path), ec);
+    return true;
+}
+
+// Carga la base y los registros del journal sobre `g` (si algo no es válido, `g` no cambia)
+bool load_game(GameState &g, const std::string &path, int *journalRecords = nullptr) {
+    GameState n;
+    save::Header h;
+    std::vector<std::uint8_t> meta;
+    if (!journal::read_merged(path, h, n.world, meta, journalRecords)) return false;
+    n.seed = h.seed;
+    n.tick = h.tick;
+    ByteReader in(meta.data(), meta.size());
+    if (!load_meta(n, in)) return false;
+    // los generadores no se guardan: se derivan de la semilla y el tick
+    n.aiRng = Rng(n.seed ^ n.tick, RNG_AI);
+    n.fxRng = Rng(n.seed ^ n.tick, RNG_EFFECTS);
+    n.light.reset(n.world);
+    n.blockPhysics.reset(n.world);
+    n.profiler = g.profiler;
+    n.jobs = g.jobs;
+    n.weatherParticles.set_capacity(g.weatherParticles.capacity());
+    n.effectParticles.set_capacity(g.effectParticles.capacity());
+    g = std::move(n);
+    return true;
+}
+
+// Hash de todo el estado que se guarda: mundo, jugador, enemigos, día y clima (FNV-1a)
+std::uint64_t state_hash(const GameState &g) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    std::uint64_t world = g.world.content_hash();
+    for (int i = 0; i < 8; ++i) { hash ^= (world >> (8 * i)) & 0xFFu; hash *= 0x100000001B3ull; }
+    for (std::uint8_t b : save_meta(g)) { hash ^= b; hash *= 0x100000001B3ull; }
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Modo headless: ejecuta la simulación sin ventana ni audio a partir de un
+// escenario y mide ticks/s y el tiempo de cada subsistema (para máquinas sin pantalla).
+//
+// Formato del escenario (una clave por línea, '#' comenta):
+//   seed 1234            semilla del mundo (--seed la sobreescribe)
+//   width 480            tamaño del mundo en tiles
+//   height 160
+//   ticks 3600           ticks a simular (--ticks lo sobreescribe)
+//   zombie 20            enemigos por tipo: zombie / skeleton / spider / creeper
+//   spread 40            distancia (en tiles) entre enemigos del mismo tipo
+//   weather rain         none / rain / snow
+//   tool pickaxe         herramienta seleccionada
+//   input 0 600 right mine   teclas mantenidas en los ticks [0, 600):
+//                            left right jump mine place swing weather
+struct ScenarioInput { unsigned long long from = 0, to = 0; TickInput keys; };
+
+struct Scenario {
+    std::uint64_t seed = 1;
+    int width = W, height = H;
+    unsigned long long ticks = 3600;
+    int counts[4] = {1, 1, 1, 1}; // por Enemy::Type
+    int spread = 24;
+    int weather = WEATHER_NONE;
+    std::string tool = "pickaxe";
+    std::vector<ScenarioInput> inputs;
+};
+
+bool load_scenario(const std::string &path, Scenario &sc) {
+    std::ifstream in(path);
+    if (!in) { std::cerr << "No pude abrir el escenario: " << path << std::endl; return false; }
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) continue;
+        if (key == "seed") ss >> sc.seed;
+        else if (key == "width") ss >> sc.width;
+        else if (key == "height") ss >> sc.height;
+        else if (key == "ticks") ss >> sc.ticks;
+        else if (key == "zombie") ss >> sc.counts[Enemy::ZOMBIE];
+        else if (key == "skeleton") ss >> sc.counts[Enemy::SKELETON];
+        else if (key == "spider") ss >> sc.counts[Enemy::SPIDER];
+        else if (key == "creeper") ss >> sc.counts[Enemy::CREEPER];
+        else if (key == "spread") ss >> sc.spread;
+        else if (key == "tool") ss >> sc.tool;
+        else if (key == "weather") {
+            std::string m; ss >> m;
+            sc.weather = m == "rain" ? WEATHER_RAIN : m == "snow" ? WEATHER_SNOW : WEATHER_NONE;
         }
-    } else if (e.vy < 0) { // rising
-        for (int ty = topTile; ty >= topTile; --ty) {
-            for (int tx = leftTile; tx <= rightTile; ++tx) {
-                if (in_bounds(tx,ty) && isSolid(get_block(world,tx,ty))) {
-                    e.y = (ty+1) * TILE; e.vy = 0; return;
-                }
+        else if (key == "input") {
+            ScenarioInput si;
+            if (!(ss >> si.from >> si.to)) { std::cerr << path << ":" << lineNo << ": se esperaba 'input desde hasta teclas...'" << std::endl; return false; }
+            std::string k;
+            while (ss >> k) {
+                if (k == "left") si.keys.left = true;
+                else if (k == "right") si.keys.right = true;
+                else if (k == "jump") si.keys.jump = true;
+                else if (k == "mine") si.keys.mineKey = true;
+                else if (k == "place") si.keys.placeFacing = true;
+                else if (k == "swing") si.keys.swing = true;
+                else if (k == "weather") si.keys.cycleWeather = true;
+                else std::cerr << path << ":" << lineNo << ": tecla desconocida '" << k << "'" << std::endl;
             }
+            sc.inputs.push_back(si);
+            continue;
         }
+        else { std::cerr << path << ":" << lineNo << ": clave desconocida '" << key << "'" << std::endl; return false; }
+        if (ss.fail()) { std::cerr << path << ":" << lineNo << ": valor inválido para '" << key << "'" << std::endl; return false; }
     }
-    e.y = newY;
+    return true;
 }
 
-int main(){
-    World world;
-    init_world(world);
+// Entrada del tick `t` según el guion: se combinan todas las líneas activas
+TickInput scenario_input(const Scenario &sc, unsigned long long t) {
+    TickInput in;
+    for (auto &si : sc.inputs) {
+        if (t < si.from || t >= si.to) continue;
+        in.left |= si.keys.left; in.right |= si.keys.right;
+        in.jump |= si.keys.jump; in.mineKey |= si.keys.mineKey;
+        in.placeFacing |= si.keys.placeFacing; in.swing |= si.keys.swing;
+        in.cycleWeather |= si.keys.cycleWeather;
+    }
+    return in;
+}
 
-    Player p{};
-    p.w = TILE-6; p.h = TILE-6;
-    p.px = (W/2) * TILE; p.vx = 0; p.vy = 0; p.fx = 1; p.fy = 0; p.selected = (char)GRASS;
-    // spawn player above surface at middle column
-    int spawnTileY = 0;
-    for (int y = 0; y < H; ++y) {
-        if (get_block(world, W/2, y) != (char)AIR) { spawnTileY = y - 1; break; }
+void print_zone_table(const Profiler &prof, double ticks, double totalMs) {
+    std::printf("%-10s %12s %10s\n", "zona", "ms/tick", "%");
+    for (auto &z : prof.get_zones())
+        std::printf("%-10s %12.5f %9.1f%%\n", z.name.c_str(), z.totalMs / ticks, totalMs > 0 ? 100.0 * z.totalMs / totalMs : 0.0);
+}
+
+int run_headless(const Scenario &sc, float dt, const std::string &savePath, const std::string &tracePath, int simThreads, int particleBudget) {
+    Profiler prof(SIM_ZONE_NAMES);
+    if (!tracePath.empty()) prof.enable_trace(HEADLESS_TRACE_EVENTS);
+    JobSystem jobs(simThreads);
+    GameState g;
+    g.jobs = &jobs;
+    g.weatherParticles.set_capacity(particleBudget);
+    g.effectParticles.set_capacity(particleBudget);
+    auto genStart = std::chrono::steady_clock::now();
+    init_game(g, sc.seed, sc.width, sc.height);
+    double genMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - genStart).count();
+    g.weatherMode = sc.weather;
+    g.p.selectedTool = tool_from_id(sc.tool);
+    // enemigos del escenario (además de los cuatro iniciales) repartidos a ambos lados del jugador
+    int mid = g.world.width() / 2;
+    for (int t = 0; t < 4; ++t) {
+        for (int i = 0; i < sc.counts[t]; ++i) {
+            int side = (i % 2) ? -1 : 1;
+            spawn_enemy(g, (Enemy::Type)t, mid + side * (8 + (i / 2) * sc.spread + t * 2));
+        }
     }
-    if (spawnTileY < 0) spawnTileY = H - 6;
-    p.py = spawnTileY * TILE;
-    // store spawn position for respawn on death
-    float spawnPx = p.px;
-    float spawnPy = p.py;
-    p.inv[(char)GRASS]=10; p.inv[(char)DIRT]=8; p.inv[(char)STONE]=6; p.inv[(char)WOOD]=3; p.inv[(char)BEDR]=0;
-    p.inv[(char)LEAF]=0; p.inv[(char)COAL]=0; p.inv[(char)IRON]=0; p.inv[(char)GOLD]=0;
-    // make new biome/nether blocks placeable
-    p.inv[(char)SAND] = 10;
-    p.inv[(char)SNOW] = 8;
-    p.inv[(char)NETH] = 2;
-    p.inv[(char)LAVA] = 1;
-    // herramientas iniciales
-    p.tools["pickaxe"] = 1;
-    p.tools["axe"] = 1;
-    p.tools["shovel"] = 1;
-    p.tools["sword"] = 1;
-    p.selectedTool = "";
-
-    // Player health
-    const int MAX_HEALTH = 5;
-    int playerHealth = MAX_HEALTH;
-    float playerInvuln = 0.0f; // seconds remaining
-    // fall damage / ground tracking
-    bool wasOnGround = true;
-    int lastGroundTile = static_cast<int>(std::floor((p.py + p.h) / TILE));
-    int fallStartTile = lastGroundTile;
-    // health regeneration
-    float regenTimer = 0.0f;
-    const float REGEN_INTERVAL = 8.0f; // seconds to recover 1 heart (faster)
-    const float REGEN_DELAY_AFTER_DAMAGE = 5.0f; // wait after last damage before regen (faster)
-    float timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // seconds since last damage
+    g.profiler = &prof;
+
+    std::cout << "Headless: seed=" << sc.seed << " mundo=" << sc.width << "x" << sc.height
+              << " hash=" << std::hex << g.world.content_hash() << std::dec
+              << " enemigos=" << g.enemies.size() << " ticks=" << sc.ticks << " dt=" << dt
+              << " hilos=" << jobs.thread_count() << std::endl;
+    std::printf("generación: %.1f ms (%.1f Mtiles/s)\n", genMs, (double)sc.width * sc.height / std::max(1e-6, genMs) / 1000.0);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long t = 0; t < sc.ticks; ++t) sim_tick(g, scenario_input(sc, t), dt);
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double ticks = (double)std::max(1ull, sc.ticks);
+    std::printf("ticks/s: %.1f  (%.4f ms/tick, %.1f s simulados en %.3f s)\n",
+                ticks * 1000.0 / std::max(1e-9, totalMs), totalMs / ticks, ticks * dt, totalMs / 1000.0);
+    print_zone_table(prof, ticks, totalMs);
+    std::printf("chunks: %zu (%zu KB)  enemigos vivos: %u/%u  particulas: %zu clima, %zu efectos  salud: %d\n",
+                g.world.chunk_count(), g.world.memory_bytes() / 1024, g.enemies.alive_count(), g.enemies.size(),
+                g.weatherParticles.size(), g.effectParticles.size(), g.playerHealth);
+    std::printf("fluidos activos: %zu  columnas por caer: %zu\n", g.blockPhysics.active_fluids(), g.blockPhysics.pending_falls());
+    std::uint64_t finalHash = g.world.content_hash();
+    std::cout << "hash final del mundo: " << std::hex << finalHash << std::dec << std::endl;
+    if (!tracePath.empty()) {
+        if (prof.write_chrome_trace(tracePath)) std::cout << "traza: " << tracePath << std::endl;
+        else std::cerr << "No pude escribir la traza en " << tracePath << std::endl;
+    }
+
+    // --save: medir guardado y carga, y comprobar que el mundo vuelve idéntico
+    if (!savePath.empty()) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!save_game(g, savePath)) { std::cerr << "No pude guardar en " << savePath << std::endl; return 1; }
+        auto t1 = std::chrono::steady_clock::now();
+        GameState loaded;
+        if (!load_game(loaded, savePath)) { std::cerr << "No pude cargar " << savePath << std::endl; return 1; }
+        auto t2 = std::chrono::steady_clock::now();
+        std::error_code ec;
+        auto bytes = std::filesystem::file_size(savePath, ec);
+        double rawBytes = (double)sc.width * sc.height;
+        std::printf("guardado: %.1f ms  carga: %.1f ms  tamaño: %llu bytes (%.2f%% de %.0f tiles)  %s\n",
+                    std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                    std::chrono::duration<double, std::milli>(t2 - t1).count(),
+                    (unsigned long long)bytes, 100.0 * bytes / rawBytes, rawBytes,
+                    loaded.world.content_hash() == finalHash ? "hash OK" : "HASH DISTINTO");
+        if (loaded.world.content_hash() != finalHash) return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Grabación de la entrada (--record) y reproducción (--replay) para comparar
+// rendimiento con partidas idénticas. Se guarda la TickInput de cada tick tal como
+// la ve la simulación, así que reproducirla en headless da el mismo estado; al
+// final se comprueba state_hash contra el de la grabación.
+//
+// Archivo: cabecera (magic, versión, semilla, tamaño del mundo, ticks/s, partículas,
+// número de ticks, hash final) y luego tramos de ticks seguidos con la misma
+// entrada: longitud (varint) + banderas (u16) + los campos que indican las banderas.
+// Grabar genera el mundo entero al empezar (sin ChunkStreamer), como el headless.
+namespace replay {
+
+const std::uint32_t MAGIC = 0x5232434D; // "MC2R"
+const std::uint32_t VERSION = 1;
+
+struct Header {
+    std::uint64_t seed = 0;
+    std::int32_t width = 0, height = 0;
+    float tickRate = 60.0f;
+    std::int32_t particleBudget = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t finalHash = 0;
+};
+
+enum : std::uint16_t {
+    IN_LEFT = 1 << 0, IN_RIGHT = 1 << 1, IN_MINE = 1 << 2, IN_MOUSE = 1 << 3, IN_JUMP = 1 << 4,
+    IN_PLACE = 1 << 5, IN_SWING = 1 << 6, IN_WEATHER = 1 << 7, IN_PLACE_MOUSE = 1 << 8,
+    IN_CRAFT = 1 << 9, IN_SELECT_BLOCK = 1 << 10, IN_SELECT_TOOL = 1 << 11
+};
+
+// Lo que no lee la simulación queda a 0 (el ratón solo cuenta con el botón pulsado),
+// para que ticks equivalentes caigan en el mismo tramo
+inline TickInput normalized(TickInput in) {
+    if (!in.mouseLeft) in.mouseWorld = sf::Vector2f();
+    if (!in.placeAtMouse) in.placeX = in.placeY = 0;
+    return in;
+}
+
+inline bool same(const TickInput &a, const TickInput &b) {
+    return a.left == b.left && a.right == b.right && a.mineKey == b.mineKey && a.mouseLeft == b.mouseLeft &&
+           a.mouseWorld == b.mouseWorld && a.jump == b.jump && a.placeFacing == b.placeFacing && a.swing == b.swing &&
+           a.cycleWeather == b.cycleWeather && a.placeAtMouse == b.placeAtMouse && a.placeX == b.placeX &&
+           a.placeY == b.placeY && a.craft == b.craft && a.selectBlock == b.selectBlock && a.selectTool == b.selectTool;
+}
+
+inline void write_varint(ByteWriter &out, std::uint64_t v) {
+    while (v >= 0x80) { out.u8((std::uint8_t)(v | 0x80)); v >>= 7; }
+    out.u8((std::uint8_t)v);
+}
+
+inline std::uint64_t read_varint(ByteReader &in) {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64 && in.ok; shift += 7) {
+        std::uint8_t b = in.u8();
+        v |= (std::uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    in.ok = false;
+    return 0;
+}
+
+inline void write_input(ByteWriter &out, const TickInput &in) {
+    std::uint16_t f = (in.left ? IN_LEFT : 0) | (in.right ? IN_RIGHT : 0) | (in.mineKey ? IN_MINE : 0) |
+                      (in.mouseLeft ? IN_MOUSE : 0) | (in.jump ? IN_JUMP : 0) | (in.placeFacing ? IN_PLACE : 0) |
+                      (in.swing ? IN_SWING : 0) | (in.cycleWeather ? IN_WEATHER : 0) | (in.placeAtMouse ? IN_PLACE_MOUSE : 0) |
+                      (in.craft >= 0 ? IN_CRAFT : 0) | (in.selectBlock >= 0 ? IN_SELECT_BLOCK : 0) |
+                      (in.selectTool >= 0 ? IN_SELECT_TOOL : 0);
+    out.u16(f);
+    if (f & IN_MOUSE) { out.f32(in.mouseWorld.x); out.f32(in.mouseWorld.y); }
+    if (f & IN_PLACE_MOUSE) { out.i32(in.placeX); out.i32(in.placeY); }
+    if (f & IN_CRAFT) out.u8((std::uint8_t)in.craft);
+    if (f & IN_SELECT_BLOCK) out.u8((std::uint8_t)in.selectBlock);
+    if (f & IN_SELECT_TOOL) out.u8((std::uint8_t)in.selectTool);
+}
+
+inline TickInput read_input(ByteReader &in) {
+    TickInput t;
+    std::uint16_t f = in.u16();
+    t.left = f & IN_LEFT; t.right = f & IN_RIGHT; t.mineKey = f & IN_MINE; t.mouseLeft = f & IN_MOUSE;
+    t.jump = f & IN_JUMP; t.placeFacing = f & IN_PLACE; t.swing = f & IN_SWING; t.cycleWeather = f & IN_WEATHER;
+    t.placeAtMouse = f & IN_PLACE_MOUSE;
+    if (f & IN_MOUSE) { t.mouseWorld.x = in.f32(); t.mouseWorld.y = in.f32(); }
+    if (f & IN_PLACE_MOUSE) { t.placeX = in.i32(); t.placeY = in.i32(); }
+    if (f & IN_CRAFT) t.craft = in.u8();
+    if (f & IN_SELECT_BLOCK) t.selectBlock = in.u8();
+    if (f & IN_SELECT_TOOL) t.selectTool = in.u8();
+    return t;
+}
+
+// Va juntando los ticks en memoria; finish() escribe el archivo con el hash final
+class Recorder {
+public:
+    Recorder(const std::string &path, const Header &h) : path(path), header(h) {}
+
+    void record(const TickInput &raw) {
+        TickInput in = normalized(raw);
+        header.ticks++;
+        if (run > 0 && same(in, last)) { run++; return; }
+        flush();
+        last = in;
+        run = 1;
+    }
+
+    bool finish(std::uint64_t finalHash) {
+        flush();
+        header.finalHash = finalHash;
+        ByteWriter out;
+        out.u32(MAGIC); out.u32(VERSION);
+        out.u64(header.seed); out.i32(header.width); out.i32(header.height);
+        out.f32(header.tickRate); out.i32(header.particleBudget);
+        out.u64(header.ticks); out.u64(header.finalHash);
+        out.raw(body.data().data(), body.data().size());
+        std::error_code ec;
+        auto dir = std::filesystem::path(path).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+        return out.write_file(path);
+    }
+
+    std::uint64_t ticks() const { return header.ticks; }
+
+private:
+    void flush() {
+        if (run == 0) return;
+        write_varint(body, run);
+        write_input(body, last);
+        run = 0;
+    }
+
+    std::string path;
+    Header header;
+    ByteWriter body;
+    TickInput last;
+    std::uint64_t run = 0;
+};
+
+} // namespace replay
+
+// --replay: reproduce una grabación en headless, mide como --scenario y comprueba el hash final
+int run_replay(const std::string &path, const std::string &tracePath, int simThreads) {
+    std::vector<std::uint8_t> bytes;
+    if (!read_file(path, bytes)) { std::cerr << "No pude abrir la grabación: " << path << std::endl; return 1; }
+    ByteReader in(bytes.data(), bytes.size());
+    replay::Header h;
+    bool okMagic = in.u32() == replay::MAGIC && in.u32() == replay::VERSION;
+    h.seed = in.u64(); h.width = in.i32(); h.height = in.i32();
+    h.tickRate = in.f32(); h.particleBudget = in.i32();
+    h.ticks = in.u64(); h.finalHash = in.u64();
+    if (!in.ok || !okMagic || h.width <= 0 || h.height <= 0 || h.tickRate <= 0.0f) {
+        std::cerr << "Grabación no válida: " << path << std::endl;
+        return 1;
+    }
+    Profiler prof(SIM_ZONE_NAMES);
+    if (!tracePath.empty()) prof.enable_trace(HEADLESS_TRACE_EVENTS);
+    JobSystem jobs(simThreads);
+    GameState g;
+    g.jobs = &jobs;
+    g.weatherParticles.set_capacity(std::max(0, h.particleBudget));
+    g.effectParticles.set_capacity(std::max(0, h.particleBudget));
+    init_game(g, h.seed, h.width, h.height);
+    g.profiler = &prof;
+    const float dt = 1.0f / h.tickRate;
+    std::cout << "Replay: " << path << " seed=" << h.seed << " mundo=" << h.width << "x" << h.height
+              << " ticks=" << h.ticks << " hilos=" << jobs.thread_count() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t done = 0;
+    while (done < h.ticks && in.ok && in.remaining() > 0) {
+        std::uint64_t run = replay::read_varint(in);
+        TickInput tick = replay::read_input(in);
+        if (!in.ok) break;
+        for (std::uint64_t i = 0; i < run && done < h.ticks; ++i, ++done) sim_tick(g, tick, dt);
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (done != h.ticks) {
+        std::cerr << "Grabación truncada: " << done << " de " << h.ticks << " ticks" << std::endl;
+        return 1;
+    }
+
+    double ticks = (double)std::max<std::uint64_t>(1, h.ticks);
+    std::printf("ticks/s: %.1f  (%.4f ms/tick, %.1f s simulados en %.3f s)\n",
+                ticks * 1000.0 / std::max(1e-9, totalMs), totalMs / ticks, ticks * dt, totalMs / 1000.0);
+    print_zone_table(prof, ticks, totalMs);
+    if (!tracePath.empty()) {
+        if (prof.write_chrome_trace(tracePath)) std::cout << "traza: " << tracePath << std::endl;
+        else std::cerr << "No pude escribir la traza en " << tracePath << std::endl;
+    }
+    std::uint64_t finalHash = state_hash(g);
+    std::cout << "hash final del estado: " << std::hex << finalHash << " (grabado " << h.finalHash << ")" << std::dec
+              << (finalHash == h.finalHash ? "  OK" : "  DISTINTO") << std::endl;
+    return finalHash == h.finalHash ? 0 : 2;
+}
+
+// Lo que se ve en el HUD cacheado: si no cambia, la capa del HUD no se redibuja
+struct HudState {
+    int health = 0;
+    bool invuln = false;
+    BlockId selected = AIR;
+    int selectedCount = 0;
+    Tool tool = TOOL_NONE;
+    std::array<int, HOTBAR.size()> counts{};
+    std::uint32_t craftable = 0;
+    bool picker = false, help = false, crafting = false;
+
+    bool operator==(const HudState &o) const {
+        return health == o.health && invuln == o.invuln && selected == o.selected && selectedCount == o.selectedCount &&
+               tool == o.tool && counts == o.counts && craftable == o.craftable && picker == o.picker && help == o.help &&
+               crafting == o.crafting;
+    }
+    bool operator!=(const HudState &o) const { return !(*this == o); }
+};
+
+HudState hud_state(const GameState &g, bool picker, bool help, bool crafting) {
+    HudState h;
+    h.health = g.playerHealth;
+    h.invuln = g.playerInvuln > 0.0f;
+    h.selected = g.p.selected;
+    h.selectedCount = g.p.inv.count(g.p.selected);
+    h.tool = g.p.selectedTool;
+    for (std::size_t i = 0; i < HOTBAR.size(); ++i) h.counts[i] = g.p.inv.count(HOTBAR[i]);
+    h.craftable = g.p.inv.craftable();
+    h.picker = picker;
+    h.help = help;
+    h.crafting = crafting;
+    return h;
+}
+
+// Panel de fabricación (G): una fila por receta, centrado en la zona de juego
+const float CRAFT_PANEL_W = 520.0f, CRAFT_ROW_H = 28.0f;
+
+sf::FloatRect craft_row_rect(int r) {
+    float panelH = (RECIPE_COUNT + 1) * CRAFT_ROW_H + 16.0f;
+    float x = ((float)VIEW_W_TILES * TILE - CRAFT_PANEL_W) * 0.5f;
+    float y = ((float)VIEW_H_TILES * TILE - panelH) * 0.5f + 8.0f + (r + 1) * CRAFT_ROW_H; // fila 0: título
+    return sf::FloatRect(x, y, CRAFT_PANEL_W, CRAFT_ROW_H);
+}
+
+// "Pico x1  <-  2 Madera + 3 Piedra"
+std::string recipe_label(const Recipe &r) {
+    std::string s = std::string(item_name(r.output)) + " x" + std::to_string(r.outputCount) + "  <-  ";
+    bool first = true;
+    for (const Ingredient &g : r.in) {
+        if (!g.count) continue;
+        if (!first) s += " + ";
+        s += std::to_string(g.count) + " " + item_name(g.item);
+        first = false;
+    }
+    return s;
+}
+
+// Overlay del profiler (F3): una fila por fase del frame, con las zonas de la
+// simulación sangradas debajo de "sim" ("light" suma también la luz que el bucle
+// de la ventana calcula fuera de la simulación: chunks que llegan o entran en la
+// vista). La barra llega a la media y la marca blanca al p99 de los últimos
+// Profiler::HISTORY frames; 16.7 ms = PROF_BAR_W. La fila de "tiles" muestra
+// además las llamadas de dibujo del último frame.
+const float PROF_BAR_W = 200.0f, PROF_ROW_H = 15.0f;
+
+void draw_profiler_overlay(sf::RenderTarget &target, const sf::Font &font, const Profiler &prof, int tileDrawCalls, float x, float y) {
+    std::vector<std::pair<int, bool>> rows = {{ZONE_FRAME, false}, {ZONE_EVENTS, false}, {ZONE_SIM, false}};
+    for (int z = 0; z < SIM_ZONE_COUNT; ++z) rows.push_back({z, true});
+    for (int z = ZONE_STREAM; z < ZONE_COUNT; ++z) rows.push_back({z, false});
+    sf::RectangleShape panel(sf::Vector2f(PROF_BAR_W + 330.0f, rows.size() * PROF_ROW_H + 28.0f));
+    panel.setPosition(x, y);
+    panel.setFillColor(sf::Color(0,0,0,180));
+    target.draw(panel);
+    sf::Text title("ms/frame   min / media / p99   (F3 cerrar, F4 traza)", font, 12);
+    title.setFillColor(sf::Color::White);
+    title.setPosition(x + 6.0f, y + 4.0f);
+    target.draw(title);
+    const float msToPx = PROF_BAR_W / (1000.0f / 60.0f);
+    char buf[64];
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        int zone = rows[i].first;
+        float ry = y + 22.0f + i * PROF_ROW_H;
+        Profiler::Stats st = prof.frame_stats(zone);
+        sf::Text name((rows[i].second ? "  " : "") + prof.get_zones()[zone].name, font, 12);
+        name.setFillColor(rows[i].second ? sf::Color(180,180,180) : sf::Color::White);
+        name.setPosition(x + 6.0f, ry);
+        target.draw(name);
+        float bx = x + 90.0f;
+        sf::RectangleShape bar(sf::Vector2f(std::min(PROF_BAR_W, st.avgMs * msToPx), PROF_ROW_H - 4.0f));
+        bar.setPosition(bx, ry + 2.0f);
+        bar.setFillColor(st.p99Ms > 1000.0f / 60.0f ? sf::Color(220,60,40) : sf::Color(60,170,90));
+        target.draw(bar);
+        sf::RectangleShape mark(sf::Vector2f(2.0f, PROF_ROW_H - 2.0f));
+        mark.setPosition(bx + std::min(PROF_BAR_W, st.p99Ms * msToPx), ry + 1.0f);
+        mark.setFillColor(sf::Color::White);
+        target.draw(mark);
+        if (zone == ZONE_TILES) std::snprintf(buf, sizeof(buf), "%6.2f %6.2f %6.2f  %d llamadas", st.minMs, st.avgMs, st.p99Ms, tileDrawCalls);
+        else std::snprintf(buf, sizeof(buf), "%6.2f %6.2f %6.2f", st.minMs, st.avgMs, st.p99Ms);
+        sf::Text vals(buf, font, 12);
+        vals.setFillColor(sf::Color::White);
+        vals.setPosition(bx + PROF_BAR_W + 12.0f, ry);
+        target.draw(vals);
+    }
+}
+
+int main(int argc, char **argv){
+    // Opciones: --tick-rate N (ticks de simulación por segundo), --max-steps N (ticks máximos por frame)
+    // --seed N (mundo reproducible), --width N / --height N (tamaño del mundo en tiles),
+    // --gen-threads N (hilos de generación en segundo plano; 0 = generar todo al inicio).
+    // --sim-threads N (hilos extra para la IA y la física de los enemigos; 0 = solo el principal).
+    // --particles N (máximo de partículas de clima y, aparte, de efectos; 0 = sin partículas).
+    // --load [archivo] (continuar una partida; F5 guarda, F9 carga, al cerrar se guarda).
+    // --autosave S (segundos de juego entre autoguardados incrementales; 0 = desactivado).
+    // Headless: --headless [--scenario archivo] [--ticks N] [--save archivo] [--trace archivo.json]
+    // --record archivo (grabar la entrada de cada tick); --replay archivo [--trace ...] (reproducirla en headless).
+    float tickRate = 60.0f;
+    int maxStepsPerFrame = 5;
+    bool headless = false;
+    std::string scenarioPath;
+    long long ticksOverride = -1;
+    bool hasSeed = false;
+    std::uint64_t seed = (std::uint64_t)time(nullptr);
+    int worldW = W, worldH = H;
+    std::string loadPath, savePath, tracePath, recordPath, replayPath;
+    float autosaveSeconds = 30.0f;
+    int genThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    int simThreads = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    int particleBudget = PARTICLE_BUDGET;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tick-rate" && i + 1 < argc) tickRate = std::max(1.0f, (float)std::atof(argv[++i]));
+        else if (arg == "--max-steps" && i + 1 < argc) maxStepsPerFrame = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--headless") headless = true;
+        else if (arg == "--scenario" && i + 1 < argc) { scenarioPath = argv[++i]; headless = true; }
+        else if (arg == "--ticks" && i + 1 < argc) ticksOverride = std::atoll(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) { seed = std::strtoull(argv[++i], nullptr, 10); hasSeed = true; }
+        else if (arg == "--width" && i + 1 < argc) worldW = std::max(VIEW_W_TILES * 2, std::atoi(argv[++i]));
+        else if (arg == "--height" && i + 1 < argc) worldH = std::max(VIEW_H_TILES * 2, std::atoi(argv[++i]));
+        else if (arg == "--gen-threads" && i + 1 < argc) genThreads = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--sim-threads" && i + 1 < argc) simThreads = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--particles" && i + 1 < argc) particleBudget = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--load") loadPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : DEFAULT_SAVE_PATH;
+        else if (arg == "--save" && i + 1 < argc) savePath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--autosave" && i + 1 < argc) autosaveSeconds = std::max(0.0f, (float)std::atof(argv[++i]));
+    }
+    const float SIM_DT = 1.0f / tickRate;
+
+    if (!replayPath.empty()) return run_replay(replayPath, tracePath, simThreads);
+    if (headless) {
+        Scenario sc;
+        if (!scenarioPath.empty() && !load_scenario(scenarioPath, sc)) return 1;
+        if (ticksOverride >= 0) sc.ticks = (unsigned long long)ticksOverride;
+        if (hasSeed) sc.seed = seed;
+        return run_headless(sc, SIM_DT, savePath, tracePath, simThreads, particleBudget);
+    }
+
+    // una grabación empieza en un mundo nuevo generado entero, como lo reproduce --replay
+    if (!recordPath.empty()) {
+        if (!loadPath.empty()) std::cerr << "Aviso: --record empieza un mundo nuevo, se ignora --load" << std::endl;
+        loadPath.clear();
+        genThreads = 0;
+    }
+
+    JobSystem jobs(simThreads);
+    GameState g;
+    g.jobs = &jobs;
+    g.weatherParticles.set_capacity(particleBudget);
+    g.effectParticles.set_capacity(particleBudget);
+    int journalRecords = 0;
+    bool loaded = !loadPath.empty() && load_game(g, loadPath, &journalRecords);
+    if (loaded) {
+        std::cout << "Partida cargada de " << loadPath << " (" << journalRecords << " autoguardados del journal)" << std::endl;
+        g.world.set_unloaded_block(genThreads > 0 ? BEDR : AIR);
+        if (genThreads == 0) generate_missing_chunks(g.world, g.seed);
+    } else {
+        if (!loadPath.empty()) std::cerr << "Aviso: no pude cargar " << loadPath << ", creando un mundo nuevo." << std::endl;
+        init_game(g, seed, worldW, worldH, genThreads > 0);
+    }
+    // Autoguardado: cada intervalo se encola una copia de los chunks modificados y el
+    // hilo del Autosaver la añade al journal; el bucle principal no espera al disco.
+    // Una partida que no viene de DEFAULT_SAVE_PATH empieza con una base completa.
+    Autosaver autosaver(DEFAULT_SAVE_PATH);
+    bool autosaveNeedsBase = !loaded || loadPath != DEFAULT_SAVE_PATH;
+    const unsigned long long AUTOSAVE_TICKS = (unsigned long long)std::llround(autosaveSeconds * tickRate);
+    unsigned long long nextAutosaveTick = g.tick + AUTOSAVE_TICKS;
+    auto autosave = [&](bool full) {
+        if (full || autosaveNeedsBase || !autosaver.has_base()) {
+            autosaver.submit(journal::snapshot_full(g.world, save_header(g), save_meta(g)));
+            autosaveNeedsBase = false;
+        } else {
+            autosaver.submit(journal::snapshot_dirty(g.world, save_header(g), save_meta(g)));
+        }
+        nextAutosaveTick = g.tick + AUTOSAVE_TICKS;
+    };
+    // con generación en segundo plano el resto del mundo llega por chunks alrededor de la cámara
+    // (en una partida cargada solo faltan los chunks que nunca se llegaron a generar)
+    std::unique_ptr<ChunkStreamer> streamer;
+    auto startStreamer = [&]() {
+        streamer.reset();
+        if (genThreads > 0) streamer.reset(new ChunkStreamer(WorldGen(g.seed, g.world.width(), g.world.height()), genThreads));
+    };
+    startStreamer();
+    if (streamer) std::cout << "Mundo: semilla " << g.seed << ", " << g.world.width() << "x" << g.world.height() << ", generando con " << genThreads << " hilos" << std::endl;
+    else std::cout << "Mundo: semilla " << g.seed << ", hash " << std::hex << g.world.content_hash() << std::dec << std::endl;
+    const int GEN_RADIUS = 2; // chunks alrededor de la cámara que se piden a los hilos
+    std::unique_ptr<replay::Recorder> recorder;
+    if (!recordPath.empty()) {
+        replay::Header rh;
+        rh.seed = g.seed; rh.width = g.world.width(); rh.height = g.world.height();
+        rh.tickRate = tickRate; rh.particleBudget = particleBudget;
+        recorder.reset(new replay::Recorder(recordPath, rh));
+        std::cout << "Grabando la entrada en " << recordPath << std::endl;
+    }
+    // cierra la grabación con el estado actual (al salir o antes de cargar otra partida)
+    auto stopRecording = [&]() {
+        if (!recorder) return;
+        if (recorder->finish(state_hash(g))) std::cout << "Grabación: " << recorder->ticks() << " ticks en " << recordPath << std::endl;
+        else std::cerr << "Aviso: no pude escribir la grabación en " << recordPath << std::endl;
+        recorder.reset();
+    };
+    World &world = g.world;
+    Player &p = g.p;
+    auto &enemies = g.enemies;
 
     // Ventana ajustada a 1280x720: calculamos tiles visibles y usamos una cámara que sigue al jugador
-    const int VIEW_W_TILES = 40; // 1280 / 32
-    const int VIEW_H_TILES = 20; // (720 - HUD) / 32
     const int HUD_HEIGHT = 100; // larger HUD
     sf::RenderWindow window(sf::VideoMode(1280, 720), "Minecraft2D - SFML (Fisicas)");
     window.setFramerateLimit(60);
     sf::View camera(sf::FloatRect(0.f, 0.f, (float)VIEW_W_TILES * TILE, (float)VIEW_H_TILES * TILE));
     // Camera options: zoom out a bit to see more, and enable smoothing (LERP)
-    const float CAM_ZOOM = 1.40f; // >1 zooms out (shows more) - alejamos la vista un poco más
     const float CAM_LERP = 8.0f; // smoothing speed
     camera.zoom(CAM_ZOOM);
 
-    std::map<char, sf::Color> color {
-        {(char)AIR, sf::Color(135,206,235)},
-        {(char)GRASS, sf::Color(88, 166, 72)},
-        {(char)SAND, sf::Color(194,178,128)},
-        {(char)SNOW, sf::Color(235,245,255)},
-        {(char)NETH, sf::Color(120,30,30)},
-        {(char)LAVA, sf::Color(255,120,20)},
-        {(char)DIRT, sf::Color(134, 96, 67)},
-        {(char)STONE, sf::Color(120,120,120)},
-        {(char)WOOD, sf::Color(150, 111, 51)},
-        {(char)BEDR, sf::Color(40,40,40)},
-        {(char)LEAF, sf::Color(110,180,80)},
-        {(char)COAL, sf::Color(30,30,30)},
-        {(char)IRON, sf::Color(180,180,200)},
-        {(char)GOLD, sf::Color(212,175,55)}
-    };
-
-    // Friendly display names for blocks and tools (used in HUD)
-    std::map<char, std::string> blockNames {
-        {(char)GRASS, "Hierba"}, {(char)DIRT, "Tierra"}, {(char)STONE, "Piedra"}, {(char)WOOD, "Madera"}, {(char)LEAF, "Hoja"},
-        {(char)COAL, "Carbón"}, {(char)IRON, "Hierro"}, {(char)GOLD, "Oro"}, {(char)SAND, "Arena"}, {(char)SNOW, "Nieve"},
-        {(char)NETH, "Neth"}, {(char)LAVA, "Lava"}
-    };
-    std::map<std::string, std::string> toolNames {
-        {"pickaxe", "Pico"}, {"axe", "Hacha"}, {"shovel", "Pala"}, {"sword", "Espada"}
-    };
+    // colores, nombres y durezas de los bloques: BlockTraits.hpp
+    ChunkRenderer tileRenderer;
 
     sf::Font font;
     font.loadFromFile("assets/fonts/Minecraft.ttf");
-    // Cargar texturas desde assets/images (si existen)
+    // Cargar texturas desde assets/images (si existen) empaquetadas en un único atlas
     namespace fs = std::filesystem;
-    std::map<std::string, sf::Texture> textures;
-    if (fs::exists("assets/images")) {
-        for (auto &ent : fs::directory_iterator("assets/images")) {
-            if (!ent.is_regular_file()) continue;
-            std::string path = ent.path().string();
-            std::string stem = ent.path().stem().string();
-            sf::Texture tex;
-            if (tex.loadFromFile(path)) {
-                textures[stem] = std::move(tex);
-            }
-        }
-    }
+    TextureAtlas atlas;
+    if (!atlas.build("assets/images")) std::cerr << "Aviso: no pude crear el atlas de texturas." << std::endl;
+    // regiones del atlas resueltas una sola vez (-1 = sin textura, se usa color sólido)
+    int playerTex = atlas.find({"player"});
+    std::array<int, 4> enemyTex = {
+        atlas.find({"zombie"}),
+        atlas.find({"skeleton", "esqueleto"}),
+        atlas.find({"spider", "araña", "arana"}),
+        atlas.find({"creeper", "crepe"})
+    };
+    std::array<int, TOOL_COUNT> toolTex = {
+        -1, atlas.find({"pickaxe", "pico"}), atlas.find({"axe", "hacha"}),
+        atlas.find({"shovel", "pala"}), atlas.find({"sword", "espada"})
+    };
+    std::array<int, BLOCK_COUNT> blockTex; blockTex.fill(-1);
+    blockTex[GRASS] = atlas.find({"grass", "hierba"});
+    blockTex[DIRT] = atlas.find({"dirt", "tierra"});
+    blockTex[STONE] = atlas.find({"stone", "piedra"});
+    blockTex[WOOD] = atlas.find({"wood", "madera"});
+    blockTex[BEDR] = atlas.find({"bedrock"});
+    blockTex[LEAF] = atlas.find({"leaf", "hoja"});
+    blockTex[COAL] = atlas.find({"coal", "carbon"});
+    blockTex[IRON] = atlas.find({"iron", "hierro"});
+    blockTex[GOLD] = atlas.find({"gold", "oro"});
+    blockTex[SAND] = atlas.find({"sand", "arena"});
+    blockTex[SNOW] = atlas.find({"snow", "nieve"});
+    blockTex[NETH] = atlas.find({"netherrack", "neth"});
+    blockTex[LAVA] = atlas.find({"lava"});
+    blockTex[WATER] = atlas.find({"water", "agua"});
+    tileRenderer.set_atlas(&atlas, blockTex);
 
     // Música de fondo: escoger un archivo aleatorio de assets/music si hay
     sf::Music bgm;
@@ -406,163 +1700,110 @@ int main(){
         }
     }
     if (!musicFiles.empty()) {
-        int idx = std::rand() % (int)musicFiles.size();
+        Rng musicRng((std::uint64_t)time(nullptr), 0); // la música no afecta la simulación
+        int idx = musicRng.next_int((int)musicFiles.size());
         if (bgm.openFromFile(musicFiles[idx])) { bgm.setLoop(true); bgm.setVolume(40); bgm.play(); }
         else std::cerr << "Aviso: no pude abrir " << musicFiles[idx] << std::endl;
     } else {
         std::cerr << "Aviso: carpeta 'assets/music' vacía o inexistente." << std::endl;
     }
 
-    sf::RectangleShape tileShape(sf::Vector2f(TILE, TILE));
-    sf::RectangleShape playerShape(sf::Vector2f(p.w, p.h));
-    playerShape.setFillColor(sf::Color::Yellow);
-    // sprites si hay texturas
-    sf::Sprite playerSprite;
-    bool playerHasTexture = false;
-    if (textures.count("player")) { playerSprite.setTexture(textures["player"]); playerHasTexture = true; }
-    if (playerHasTexture) {
-        auto &t = textures["player"];
-        if (t.getSize().x > 0 && t.getSize().y > 0) playerSprite.setScale(p.w / (float)t.getSize().x, p.h / (float)t.getSize().y);
-    }
+    // jugador y enemigos se dibujan en un único lote sobre el atlas; las partículas en otro
+    SpriteBatch entityBatch;
+    SpriteBatch particleBatch;
 
     // FPS display
     sf::Text fpsText;
     fpsText.setFont(font);
     fpsText.setCharacterSize(14);
     fpsText.setFillColor(sf::Color::White);
-
-    // Crear varios enemigos: zombi, esqueleto, araña y creeper
-    std::vector<Enemy> enemies;
-    auto spawnEnemyAt = [&](Enemy::Type t, int tileXOffset){
-        // spawn only in caves: search for an underground tile near center+offset
-        int baseX = std::min(W-2, W/2 + tileXOffset);
-        // find surface height at baseX
-        int surfaceY = 0;
-        for (int y=0;y<H;++y) { if (get_block(world, baseX, y) != (char)AIR) { surfaceY = y; break; } }
-        // search nearby columns for a cave floor (air tile with solid tile below and y > surfaceY + 2)
-        int foundX=-1, foundY=-1;
-        for (int dx=-8; dx<=8 && foundX==-1; ++dx) {
-            int cx = baseX + dx; if (cx < 1 || cx > W-2) continue;
-            for (int y = surfaceY + 3; y < H-2; ++y) {
-                if (get_block(world, cx, y) == (char)AIR && isSolid(get_block(world, cx, y+1))) { foundX = cx; foundY = y; break; }
-            }
-        }
-        if (foundX == -1) return; // no cave found nearby
-        Enemy e{};
-        e.type = t; e.w = p.w; e.h = p.h; e.vx = 0; e.vy = 0; e.dir = (std::rand()%2)?1:-1; e.moveSpeed = 60.0f; e.pauseTimer = 0.0f; e.fuseTimer = 0.0f; e.alive = true;
-        e.x = foundX * TILE; e.y = (foundY - 1) * TILE; // stand on the block above the floor AIR
-        e.spawnTileX = foundX; e.spawnTileY = foundY - 1;
-        e.respawnTimer = 0.0f;
-        // set HP by type
-        if (t == Enemy::ZOMBIE) { e.maxHp = 2; }
-        else { e.maxHp = 1; }
-        e.hp = e.maxHp;
-        // tweak per type
-        if (t == Enemy::SPIDER) { e.moveSpeed = 80.0f; }
-        if (t == Enemy::CREEPER) { e.moveSpeed = 30.0f; }
-        if (t == Enemy::SKELETON) { e.moveSpeed = 60.0f; }
-        enemies.push_back(e);
-    };
-    spawnEnemyAt(Enemy::ZOMBIE, 6);
-    spawnEnemyAt(Enemy::SKELETON, -6);
-    spawnEnemyAt(Enemy::SPIDER, 10);
-    spawnEnemyAt(Enemy::CREEPER, -10);
-
-    sf::RectangleShape enemyShape(sf::Vector2f(p.w, p.h));
-
-    const float GRAVITY = 1500.0f; // px/s^2
-    const float MOVE_SPEED = 150.0f; // px/s
-    const float JUMP_SPEED = 520.0f; // px/s
-    // Sword (attack) mechanics
-    const float SWING_RANGE = 64.0f; // px (increased reach)
-    const float SWING_COOLDOWN = 0.5f; // s (quicker swings)
-    const float SWING_ACTIVE = 0.15f; // s (shorter hit window)
-    float swingTimer = 0.0f;
-    float swingActive = 0.0f;
-    const float ENEMY_RESPAWN_BASE = 8.0f; // base seconds before enemy can respawn (faster)
-    const float ENEMY_RESPAWN_VAR = 4.0f; // random additional seconds (0..VAR)
-    const int SWORD_DAMAGE = 1; // damage per hit
-    const float DAY_LENGTH = 120.0f; // seconds for full day-night cycle
-    float dayTime = 0.0f;
-    const float PI = 3.14159265358979323846f;
-
-    // Weather system
-    enum WeatherMode { WEATHER_NONE = 0, WEATHER_RAIN = 1, WEATHER_SNOW = 2 };
-    int weatherMode = WEATHER_NONE;
-    struct WeatherParticle { float x; float y; float vy; float life; bool snow; };
-    std::vector<WeatherParticle> weatherParticles;
-    const float WEATHER_RAIN_SPAWN_PER_SEC = 180.0f; // spawn rate per second per screen
-    const float WEATHER_SNOW_SPAWN_PER_SEC = 60.0f;
-    float weatherSpawnAcc = 0.0f;
-    // Effect particles (sparks, explosion debris)
-    struct EffectParticle { float x; float y; float vx; float vy; float life; float size; sf::Color col; };
-    std::vector<EffectParticle> effectParticles;
+    float fpsTimer = 0.0f; // el texto de FPS se actualiza unas 4 veces por segundo
+    int fpsFrames = 0;
+
+    // HUD (corazones, herramientas, panel del bloque, inventario, selector y ayuda)
+    // en una textura aparte: solo se redibuja cuando cambia lo que muestra
+    // (HudState) y cada frame se compone con un único sprite. Si no se puede crear
+    // la textura se dibuja directamente en la ventana como antes.
+    sf::RenderTexture hudLayer;
+    bool hudCached = hudLayer.create(window.getSize().x, window.getSize().y);
+    HudState hudShown;
+    bool hudValid = false;
+
+    // Tiempos por fase del frame y de la simulación (F3 overlay, F4 vuelca la traza)
+    std::vector<std::string> profZoneNames = SIM_ZONE_NAMES;
+    profZoneNames.insert(profZoneNames.end(), FRAME_ZONE_NAMES.begin(), FRAME_ZONE_NAMES.end());
+    Profiler frameProf(profZoneNames);
+    frameProf.enable_trace(FRAME_TRACE_EVENTS);
+    g.profiler = &frameProf;
+    bool showProfiler = false;
 
     sf::Clock clock;
-    // Picar bloques por tiempo
-    bool breaking = false;
-    int breakX = -1, breakY = -1;
-    float breakProgress = 0.0f;
-    const float BASE_BREAK_TIME = 0.6f; // segundos base (ligeramente más rápido)
-    bool prevMouseLeft = false; // for edge detection of left click
     bool showBlockPicker = false; // F toggles a block selection overlay
     bool showHelp = false; // H toggles help panel
-    const int INV_SLOTS = 12; // inventory slots shown at bottom
+    bool showCrafting = false; // G toggles crafting panel
+    const int INV_SLOTS = (int)HOTBAR.size(); // inventory slots shown at bottom
+    // Paso fijo: la simulación avanza en ticks de SIM_DT y el render interpola entre los dos últimos
+    TickInput input;
+    float accumulator = 0.0f;
+    bool autosaveWarned = false;
+    unsigned lastDamageCount = 0;
     while (window.isOpen()){
+        frameProf.end_frame();
+        ProfileScope frameScope(&frameProf, ZONE_FRAME);
+        ProfilePhase framePhase(&frameProf);
+        framePhase.next(ZONE_EVENTS);
         sf::Event ev;
         while (window.pollEvent(ev)){
             if (ev.type == sf::Event::Closed) window.close();
             if (ev.type == sf::Event::KeyPressed){
                 if (ev.key.code == sf::Keyboard::Escape) window.close();
-                if (ev.key.code == sf::Keyboard::Num1) { p.selected=(char)GRASS; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num2) { p.selected=(char)DIRT; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num3) { p.selected=(char)STONE; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num4) { p.selected=(char)WOOD; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num5) { p.selected=(char)LEAF; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num6) { p.selected=(char)COAL; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num7) { p.selected=(char)IRON; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num8) { p.selected=(char)GOLD; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num9) { p.selected=(char)SAND; showBlockPicker=false; }
-                if (ev.key.code == sf::Keyboard::Num0) { p.selected=(char)SNOW; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num1) { input.selectBlock=GRASS; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num2) { input.selectBlock=DIRT; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num3) { input.selectBlock=STONE; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num4) { input.selectBlock=WOOD; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num5) { input.selectBlock=LEAF; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num6) { input.selectBlock=COAL; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num7) { input.selectBlock=IRON; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num8) { input.selectBlock=GOLD; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num9) { input.selectBlock=SAND; showBlockPicker=false; }
+                if (ev.key.code == sf::Keyboard::Num0) { input.selectBlock=SNOW; showBlockPicker=false; }
                 // tecla X ahora inicia picar (mecánica por tiempo) — manejado en el bucle principal
-                if (ev.key.code == sf::Keyboard::C) {
-                    int centerX = static_cast<int>(p.px + p.w/2);
-                    int centerY = static_cast<int>(p.py + p.h/2);
-                    int tx = (centerX + p.fx * TILE) / TILE;
-                    int ty = (centerY + p.fy * TILE) / TILE;
-                    char b = p.selected;
-                    if (in_bounds(tx,ty) && get_block(world,tx,ty)==(char)AIR && p.inv[b]>0){ p.inv[b]--; set_block(world,tx,ty,b); }
-                }
-                if (ev.key.code == sf::Keyboard::W || ev.key.code == sf::Keyboard::Space || ev.key.code == sf::Keyboard::Up) {
-                    // Salto: solo si estamos sobre suelo (pequeña comprobación)
-                    int belowTileY = static_cast<int>(std::floor((p.py + p.h + 1) / TILE));
-                    int leftTile = static_cast<int>(std::floor(p.px / TILE));
-                    int rightTile = static_cast<int>(std::floor((p.px + p.w -1) / TILE));
-                    bool onGround = false;
-                    for (int tx = leftTile; tx <= rightTile; ++tx) if (in_bounds(tx,belowTileY) && isSolid(get_block(world,tx,belowTileY))) onGround = true;
-                    if (onGround) { p.vy = -JUMP_SPEED; }
-                }
+                if (ev.key.code == sf::Keyboard::C) input.placeFacing = true;
+                if (ev.key.code == sf::Keyboard::W || ev.key.code == sf::Keyboard::Space || ev.key.code == sf::Keyboard::Up) input.jump = true;
                 // tools: Q=pickaxe, E=axe, R=shovel
-                if (ev.key.code == sf::Keyboard::Q) { if (p.tools["pickaxe"]>0) p.selectedTool = "pickaxe"; else p.selectedTool = ""; }
-                if (ev.key.code == sf::Keyboard::E) { if (p.tools["axe"]>0) p.selectedTool = "axe"; else p.selectedTool = ""; }
-                if (ev.key.code == sf::Keyboard::R) { if (p.tools["shovel"]>0) p.selectedTool = "shovel"; else p.selectedTool = ""; }
-                if (ev.key.code == sf::Keyboard::T) { if (p.tools["sword"]>0) p.selectedTool = "sword"; else p.selectedTool = ""; }
+                if (ev.key.code == sf::Keyboard::Q) input.selectTool = TOOL_PICKAXE;
+                if (ev.key.code == sf::Keyboard::E) input.selectTool = TOOL_AXE;
+                if (ev.key.code == sf::Keyboard::R) input.selectTool = TOOL_SHOVEL;
+                if (ev.key.code == sf::Keyboard::T) input.selectTool = TOOL_SWORD;
                 if (ev.key.code == sf::Keyboard::F) { showBlockPicker = !showBlockPicker; }
-                if (ev.key.code == sf::Keyboard::K) {
-                    // cycle weather: none -> rain -> snow -> none
-                    weatherMode = (weatherMode + 1) % 3;
-                    weatherParticles.clear();
+                if (ev.key.code == sf::Keyboard::G) { showCrafting = !showCrafting; }
+                if (ev.key.code == sf::Keyboard::K) input.cycleWeather = true;
+                if (ev.key.code == sf::Keyboard::F5) {
+                    autosave(true);
+                    std::cout << "Guardando partida en " << DEFAULT_SAVE_PATH << std::endl;
+                }
+                if (ev.key.code == sf::Keyboard::F9) {
+                    autosaver.flush(); // que lo encolado llegue al disco antes de leerlo
+                    stopRecording();   // la partida cargada ya no sale de la grabación
+                    if (load_game(g, DEFAULT_SAVE_PATH)) {
+                        g.world.set_unloaded_block(genThreads > 0 ? BEDR : AIR);
+                        if (genThreads == 0) generate_missing_chunks(g.world, g.seed);
+                        autosaveNeedsBase = false;
+                        nextAutosaveTick = g.tick + AUTOSAVE_TICKS;
+                        startStreamer();
+                        accumulator = 0.0f;
+                        camera.setCenter(p.px + p.w*0.5f, p.py + p.h*0.5f);
+                    } else std::cerr << "Aviso: no pude cargar " << DEFAULT_SAVE_PATH << std::endl;
                 }
                 if (ev.key.code == sf::Keyboard::H) {
                     showHelp = !showHelp;
                 }
-                if (ev.key.code == sf::Keyboard::F) {
-                    // sword attack
-                    // only swing if sword is selected
-                    if (p.selectedTool == "sword" && p.tools["sword"]>0) {
-                        if (swingTimer <= 0.0f) { swingTimer = SWING_COOLDOWN; swingActive = SWING_ACTIVE; }
-                    }
+                if (ev.key.code == sf::Keyboard::F3) showProfiler = !showProfiler;
+                if (ev.key.code == sf::Keyboard::F4) {
+                    if (frameProf.write_chrome_trace(PROFILE_TRACE_PATH)) std::cout << "Traza guardada en " << PROFILE_TRACE_PATH << std::endl;
+                    else std::cerr << "Aviso: no pude escribir " << PROFILE_TRACE_PATH << std::endl;
                 }
+                if (ev.key.code == sf::Keyboard::F) input.swing = true; // sword attack (si la espada está seleccionada)
             }
             if (ev.type == sf::Event::MouseButtonPressed){
                 // click handling: colocar con botón derecho (inmediato). Picar con botón izquierdo ahora se maneja manteniendo pulsado (ver loop principal).
@@ -578,20 +1819,26 @@ int main(){
                     float panelH = rows * slotH + (rows-1)*gap;
                     sf::Vector2f center((float)VIEW_W_TILES * TILE * 0.5f, (float)VIEW_H_TILES * TILE * 0.5f);
                     float startX = center.x - panelW*0.5f; float startY = center.y - panelH*0.5f;
-                    std::vector<char> picker = {(char)GRASS,(char)DIRT,(char)STONE,(char)WOOD,(char)LEAF,(char)COAL,(char)IRON,(char)GOLD,(char)SAND,(char)SNOW,(char)NETH,(char)LAVA};
                     for (int i = 0; i < INV_SLOTS; ++i) {
                         int r = i / cols; int c = i % cols;
                         float sx = startX + c * (slotW + gap);
                         float sy = startY + r * (slotH + gap);
                         sf::FloatRect rect(sx, sy, slotW, slotH);
                         if (hudPos.x >= rect.left && hudPos.x <= rect.left + rect.width && hudPos.y >= rect.top && hudPos.y <= rect.top + rect.height) {
-                            if (i < (int)picker.size()) { p.selected = picker[i]; }
+                            if (i < (int)HOTBAR.size()) { input.selectBlock = HOTBAR[i]; }
                             showBlockPicker = false;
                             break;
                         }
                     }
                     continue;
                 }
+                // panel de fabricación: el clic en una receta la fabrica en el próximo tick
+                if (showCrafting && ev.mouseButton.button == sf::Mouse::Left) {
+                    sf::Vector2f hudPos = window.mapPixelToCoords(m, window.getDefaultView());
+                    for (int r = 0; r < RECIPE_COUNT; ++r)
+                        if (craft_row_rect(r).contains(hudPos)) { input.craft = r; break; }
+                    continue;
+                }
                 // check clicks on HUD inventory (default view coords)
                 sf::Vector2f hudPos = window.mapPixelToCoords(m, window.getDefaultView());
                 // inventory slots are at y = VIEW_H_TILES * TILE + 16, slots width 48, stride 60, start x=10
@@ -602,8 +1849,7 @@ int main(){
                         if (relX >= 0) {
                             int idx = relX / 60;
                             if (idx >= 0 && idx < INV_SLOTS) {
-                                std::vector<char> mapSel = {(char)GRASS,(char)DIRT,(char)STONE,(char)WOOD,(char)LEAF,(char)COAL,(char)IRON,(char)GOLD,(char)SAND,(char)SNOW,(char)NETH,(char)LAVA};
-                                p.selected = mapSel[idx];
+                                input.selectBlock = HOTBAR[idx];
                                 // consume this click for HUD selection
                                 continue;
                             }
@@ -614,18 +1860,47 @@ int main(){
                 sf::Vector2f worldPos = window.mapPixelToCoords(m, camera);
                 int mx = static_cast<int>(std::floor(worldPos.x)) / TILE; int my = static_cast<int>(std::floor(worldPos.y)) / TILE;
                 if (ev.mouseButton.button == sf::Mouse::Right){
-                    if (in_bounds(mx,my)){
-                        char b = p.selected;
-                        if (get_block(world,mx,my)==(char)AIR && p.inv[b]>0){ p.inv[b]--; set_block(world,mx,my,b); }
-                    }
+                    input.placeAtMouse = true; input.placeX = mx; input.placeY = my;
                 }
             }
         }
 
         float dt = clock.restart().asSeconds();
-        // advance day-night time
-        dayTime += dt;
-        float phase = std::fmod(dayTime, DAY_LENGTH) / DAY_LENGTH; // 0..1
+
+        // estado mantenido de teclado/ratón para los ticks de este frame
+        input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::A) || sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+        input.right = !input.left && (sf::Keyboard::isKeyPressed(sf::Keyboard::D) || sf::Keyboard::isKeyPressed(sf::Keyboard::Right));
+        input.mineKey = sf::Keyboard::isKeyPressed(sf::Keyboard::X);
+        input.mouseLeft = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+        input.mouseWorld = window.mapPixelToCoords(sf::Mouse::getPosition(window), camera);
+
+        framePhase.next(ZONE_SIM);
+        accumulator += dt;
+        int steps = 0;
+        while (accumulator >= SIM_DT && steps < maxStepsPerFrame) {
+            if (recorder) recorder->record(input);
+            sim_tick(g, input, SIM_DT);
+            input.clear_actions();
+            accumulator -= SIM_DT;
+            steps++;
+        }
+        if (AUTOSAVE_TICKS > 0 && g.tick >= nextAutosaveTick) autosave(false);
+        if (autosaver.failed() && !autosaveWarned) {
+            std::cerr << "Aviso: falló el autoguardado en " << DEFAULT_SAVE_PATH << std::endl;
+            autosaveWarned = true;
+        }
+        // demasiado atraso (p.ej. ventana arrastrada): descartar en vez de entrar en espiral
+        if (accumulator >= SIM_DT) accumulator = std::fmod(accumulator, SIM_DT);
+        float interp = accumulator / SIM_DT; // 0..1 entre el tick anterior y el actual
+        auto lerpF = [interp](float a, float b){ return a + (b - a) * interp; };
+        float playerX = lerpF(p.prevPx, p.px), playerY = lerpF(p.prevPy, p.py);
+
+        if (g.damageCount != lastDamageCount) {
+            lastDamageCount = g.damageCount;
+            if (hasDamageSound) damageSound.play();
+        }
+
+        float phase = std::fmod(g.dayTime, DAY_LENGTH) / DAY_LENGTH; // 0..1
         float sun = 0.5f + 0.5f * std::sin(phase * 2.0f * PI); // -? maps 0..1
         float ambient = 0.4f + 0.6f * sun; // 0.4..1.0
         // sky color: lerp between night and day using sun
@@ -634,315 +1909,14 @@ int main(){
         auto lerpC = [&](const sf::Color &a, const sf::Color &b, float t){ return sf::Color((sf::Uint8)(a.r * t + b.r * (1.0f-t)), (sf::Uint8)(a.g * t + b.g * (1.0f-t)), (sf::Uint8)(a.b * t + b.b * (1.0f-t))); };
         sf::Color skyColor = lerpC(daySky, nightSky, 1.0f - sun);
 
-        // update swing timers
-        if (swingTimer > 0.0f) swingTimer = std::max(0.0f, swingTimer - dt);
-        if (swingActive > 0.0f) swingActive = std::max(0.0f, swingActive - dt);
-
-        // Input horizontal
-        float targetVx = 0;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::A) || sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) { targetVx = -MOVE_SPEED; p.fx = -1; }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::D) || sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) { targetVx = MOVE_SPEED; p.fx = 1; }
-        else { targetVx = 0; }
-        p.vx = targetVx;
-
-        // Apply gravity
-        p.vy += GRAVITY * dt;
-        if (p.vy > 2000.0f) p.vy = 2000.0f;
-
-        // Move horizontally and resolve collisions
-        float newPx = p.px + p.vx * dt;
-        resolveHorizontal(world, p, newPx);
-
-        // Move vertically and resolve collisions
-        float newPy = p.py + p.vy * dt;
-        resolveVertical(world, p, newPy);
-
-        // update facing y
-        p.fy = (p.vy > 0) ? 1 : (p.vy < 0 ? -1 : 0);
-
-        // Fall damage detection: check landing and start-fall
-        int leftTile = static_cast<int>(std::floor(p.px / TILE));
-        int rightTile = static_cast<int>(std::floor((p.px + p.w -1) / TILE));
-        int belowTileY = static_cast<int>(std::floor((p.py + p.h + 1) / TILE));
-        bool onGround = false;
-        for (int tx = leftTile; tx <= rightTile; ++tx) if (in_bounds(tx,belowTileY) && isSolid(get_block(world,tx,belowTileY))) onGround = true;
-        if (!wasOnGround && onGround) {
-            // landed
-            int landingTile = belowTileY;
-            int dropTiles = landingTile - fallStartTile;
-            if (dropTiles >= 5 && playerInvuln <= 0.0f) {
-                playerHealth = std::max(0, playerHealth - 1);
-                playerInvuln = 1.0f;
-                timeSinceDamage = 0.0f;
-                if (hasDamageSound) damageSound.play();
-            }
-        }
-        if (wasOnGround && !onGround) {
-            // started falling: record the ground tile we left
-            fallStartTile = lastGroundTile;
-        }
-        if (onGround) lastGroundTile = belowTileY;
-        wasOnGround = onGround;
-
-        // --- Mecánica de picar por tiempo / ataque con clic izquierdo ---
-        bool keyBreak = sf::Keyboard::isKeyPressed(sf::Keyboard::X);
-        bool curMouseLeft = sf::Mouse::isButtonPressed(sf::Mouse::Left);
-        bool mousePressedThisFrame = (curMouseLeft && !prevMouseLeft);
-        // if sword is selected, left-click triggers attack on press instead of mining
-        bool mouseBreak = false;
-        if (curMouseLeft) {
-            if (p.selectedTool == "sword" && p.tools["sword"]>0) {
-                mouseBreak = false; // do not mine while sword held
-            } else {
-                mouseBreak = true;
-            }
-        }
-        int targetX = -1, targetY = -1;
-        if (keyBreak) {
-            int centerX = static_cast<int>(p.px + p.w/2);
-            int centerY = static_cast<int>(p.py + p.h/2);
-            targetX = (centerX + p.fx * TILE) / TILE;
-            targetY = (centerY + p.fy * TILE) / TILE;
-        } else if (mouseBreak) {
-            sf::Vector2i mpos = sf::Mouse::getPosition(window);
-            sf::Vector2f wp = window.mapPixelToCoords(mpos, camera);
-            targetX = static_cast<int>(std::floor(wp.x)) / TILE; targetY = static_cast<int>(std::floor(wp.y)) / TILE;
-        }
-
-        if (targetX != -1 && in_bounds(targetX, targetY)) {
-            char tb = get_block(world, targetX, targetY);
-            if (tb != (char)AIR && tb != (char)BEDR) {
-                // determine break time modifier by block type
-                float mult = 1.0f;
-                if (tb == (char)STONE) mult = 2.0f;
-                else if (tb == (char)WOOD) mult = 0.8f;
-                else if (tb == (char)LEAF) mult = 0.4f;
-                else if (tb == (char)COAL) mult = 1.2f;
-                else if (tb == (char)IRON) mult = 3.0f;
-                else if (tb == (char)GOLD) mult = 4.0f;
-
-                // tool modifiers: improved pickaxe/axe/shovel effectiveness
-                if (p.selectedTool == "pickaxe" && p.tools["pickaxe"]>0) {
-                    if (tb == (char)STONE || tb == (char)IRON || tb == (char)GOLD || tb == (char)COAL) mult *= 0.45f;
-                }
-                if (p.selectedTool == "axe" && p.tools["axe"]>0) {
-                    if (tb == (char)WOOD || tb == (char)LEAF) mult *= 0.45f;
-                }
-                if (p.selectedTool == "shovel" && p.tools["shovel"]>0) {
-                    if (tb == (char)DIRT || tb == (char)SAND) mult *= 0.45f;
-                }
-
-                if (breaking && breakX == targetX && breakY == targetY) {
-                    breakProgress += dt;
-                } else {
-                    breaking = true;
-                    breakX = targetX; breakY = targetY; breakProgress = dt;
-                }
-
-                float need = BASE_BREAK_TIME * mult;
-                if (breakProgress >= need) {
-                    // completar ruptura
-                    p.inv[tb]++;
-                    set_block(world, breakX, breakY, (char)AIR);
-                    breaking = false; breakX = breakY = -1; breakProgress = 0.0f;
-                }
-            } else {
-                // objetivo no picable
-                breaking = false; breakX = breakY = -1; breakProgress = 0.0f;
-            }
-        } else {
-            // no está picando
-            breaking = false; breakX = breakY = -1; breakProgress = 0.0f;
-        }
-
-        // Actualizar enemigos (solo procesar IA/colisiones cuando estén cerca para mejorar rendimiento)
-        for (auto &e : enemies) {
-            // always decrement respawn timers for dead ones
-            if (!e.alive) {
-                if (e.respawnTimer > 0.0f) e.respawnTimer = std::max(0.0f, e.respawnTimer - dt);
-                // try respawn when timer reaches 0 (handled below in common code)
-            } else {
-                // if alive, only process when close to player
-                float exCenter = e.x + e.w*0.5f;
-                float pxCenter = p.px + p.w*0.5f;
-                float dxE = pxCenter - exCenter;
-                float dyE = (p.py + p.h*0.5f) - (e.y + e.h*0.5f);
-                float dist = std::hypot(dxE, dyE);
-                const float ACTIVE_RANGE = 1200.0f; // px
-                if (dist < ACTIVE_RANGE) {
-                    e.vy += GRAVITY * dt;
-                    if (e.vy > 2000.0f) e.vy = 2000.0f;
-
-                    float distE = std::abs(dxE);
-                    if (e.pauseTimer > 0.0f) { e.pauseTimer -= dt; e.vx = 0.0f; }
-                    else {
-                        if (e.type == Enemy::ZOMBIE || e.type == Enemy::SKELETON) {
-                            if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed;
-                            else { e.vx = e.moveSpeed * e.dir; if ((std::rand() % 1000) < 8) { e.dir = -e.dir; e.pauseTimer = 0.35f; e.vx = 0.0f; } }
-                        } else if (e.type == Enemy::SPIDER) {
-                            // spider: can jump higher towards player
-                            int belowTileY = static_cast<int>(std::floor((e.y + e.h + 1) / TILE));
-                            int leftTile = static_cast<int>(std::floor(e.x / TILE));
-                            int rightTile = static_cast<int>(std::floor((e.x + e.w -1) / TILE));
-                            bool onGround = false;
-                            for (int tx = leftTile; tx <= rightTile; ++tx) if (in_bounds(tx,belowTileY) && isSolid(get_block(world,tx,belowTileY))) onGround = true;
-                            if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed;
-                            else e.vx = e.moveSpeed * e.dir;
-                            if (onGround && distE < 250.0f && (std::rand()%100) < 25) { e.vy = -JUMP_SPEED * 1.15f; }
-                        } else if (e.type == Enemy::CREEPER) {
-                            // creeper: slow approach, when close start fuse and explode
-                            const float triggerDist = 160.0f;
-                            if (distE < triggerDist && e.fuseTimer <= 0.0f) { e.fuseTimer = 1.6f; }
-                            if (e.fuseTimer > 0.0f) { e.fuseTimer -= dt; if (e.fuseTimer <= 0.0f) {
-                                // explode: clear nearby blocks (2-tile radius)
-                                int radiusTiles = 2;
-                                int cx = static_cast<int>(std::floor((e.x + e.w*0.5f) / TILE));
-                                int cy = static_cast<int>(std::floor((e.y + e.h*0.5f) / TILE));
-                                for (int oy = -radiusTiles; oy <= radiusTiles; ++oy) for (int ox = -radiusTiles; ox <= radiusTiles; ++ox) {
-                                    int bx = cx + ox; int by = cy + oy;
-                                    if (in_bounds(bx,by) && get_block(world,bx,by)!=(char)BEDR) set_block(world,bx,by,(char)AIR);
-                                }
-                                // spawn explosion effect particles and camera shake
-                                float ex = e.x + e.w*0.5f; float ey = e.y + e.h*0.5f;
-                                for (int pi = 0; pi < 20; ++pi) {
-                                    EffectParticle ep; ep.x = ex; ep.y = ey; ep.vx = (std::rand()%200 - 100) * 3.0f; ep.vy = (std::rand()%200 - 200) * 3.0f; ep.life = 0.8f + (std::rand()%100)/200.0f; ep.size = 2.0f + (std::rand()%6); ep.col = (pi%2==0) ? sf::Color(255,180,60) : sf::Color(180,80,40); effectParticles.push_back(ep);
-                                }
-                                // damage player if inside explosion
-                                float edist = std::hypot((pxCenter - ex), ((p.py + p.h*0.5f) - ey));
-                                if (edist < (radiusTiles * TILE + 8.0f) && playerInvuln <= 0.0f) { playerHealth = std::max(0, playerHealth - 1); playerInvuln = 1.0f; timeSinceDamage = 0.0f; if (hasDamageSound) damageSound.play(); }
-                                e.alive = false; e.vx = e.vy = 0.0f;
-                                // randomized respawn time
-                                e.respawnTimer = ENEMY_RESPAWN_BASE + (std::rand() % ((int)ENEMY_RESPAWN_VAR + 1));
-                            } }
-                            // approach slowly while not fusing
-                            if (e.fuseTimer <= 0.0f) {
-                                if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed; else e.vx = e.moveSpeed * e.dir;
-                            } else e.vx = 0.0f; // fuse pause movement
-                        }
-                    }
-
-                    float newEx = e.x + e.vx * dt;
-                    resolveHorizontalEnemy(world, e, newEx);
-                    float newEy = e.y + e.vy * dt;
-                    resolveVerticalEnemy(world, e, newEy);
-
-                    // collision damage to player (creeper handled on explosion)
-                    if (playerInvuln <= 0.0f && e.alive && e.type != Enemy::CREEPER) {
-                        float ax1 = e.x, ay1 = e.y, ax2 = e.x + e.w, ay2 = e.y + e.h;
-                        float bx1 = p.px, by1 = p.py, bx2 = p.px + p.w, by2 = p.py + p.h;
-                        bool overlap = (ax1 < bx2 && ax2 > bx1 && ay1 < by2 && ay2 > by1);
-                        if (overlap) { playerHealth = std::max(0, playerHealth - 1); playerInvuln = 1.0f; timeSinceDamage = 0.0f; if (hasDamageSound) damageSound.play(); }
-                    }
-                } // end if dist < ACTIVE_RANGE
-            }
-            // handle dead enemies respawn timer (improved): postpone if player nearby and choose safe nearby spot
-            if (!e.alive) {
-                if (e.respawnTimer > 0.0f) {
-                    // already decremented above maybe; keep safe
-                } else if (e.respawnTimer <= 0.0f) {
-                    // avoid respawn if player is very close to spawn
-                    float spawnCx = e.spawnTileX * TILE + TILE*0.5f;
-                    float spawnCy = e.spawnTileY * TILE + TILE*0.5f;
-                    float pxCenter = p.px + p.w*0.5f; float pyCenter = p.py + p.h*0.5f;
-                    float pdist = std::hypot(pxCenter - spawnCx, pyCenter - spawnCy);
-                    if (pdist < 5.0f * TILE) {
-                        // push respawn a bit further
-                        e.respawnTimer = 2.0f + (std::rand() % 3);
-                    } else {
-                        bool placed = false;
-                        // search for a nearby suitable tile (air with solid below)
-                        for (int r = 0; r <= 6 && !placed; ++r) {
-                            for (int dx = -r; dx <= r && !placed; ++dx) for (int dy = -r; dy <= r && !placed; ++dy) {
-                                int tx = e.spawnTileX + dx; int ty = e.spawnTileY + dy;
-                                if (!in_bounds(tx, ty)) continue;
-                                if (get_block(world, tx, ty) == (char)AIR && isSolid(get_block(world, tx, ty+1))) {
-                                    e.x = tx * TILE; e.y = ty * TILE; e.alive = true; e.hp = e.maxHp; e.vx = 0.0f; e.vy = 0.0f; e.fuseTimer = 0.0f; e.pauseTimer = 0.8f; placed = true; break;
-                                }
-                            }
-                        }
-                        if (!placed) {
-                            // fallback: respawn at exact spawn tile
-                            e.x = e.spawnTileX * TILE; e.y = e.spawnTileY * TILE; e.alive = true; e.hp = e.maxHp; e.vx = 0.0f; e.vy = 0.0f; e.fuseTimer = 0.0f; e.pauseTimer = 0.8f;
-                        }
-                    }
-                }
-            }
-        }
-
-        // Sword hit detection while swingActive > 0
-        if (swingActive > 0.0f) {
-            float attackX = (p.fx >= 0) ? (p.px + p.w) : (p.px - SWING_RANGE);
-            float attackY = p.py;
-            float attackW = SWING_RANGE;
-            float attackH = p.h;
-            for (auto &e : enemies) {
-                if (!e.alive) continue;
-                float ax1 = attackX, ay1 = attackY, ax2 = attackX + attackW, ay2 = attackY + attackH;
-                float bx1 = e.x, by1 = e.y, bx2 = e.x + e.w, by2 = e.y + e.h;
-                bool hit = (ax1 < bx2 && ax2 > bx1 && ay1 < by2 && ay2 > by1);
-                if (hit) {
-                    // only damage if sword is selected
-                    if (p.selectedTool == "sword" && p.tools["sword"]>0) {
-                        e.hp -= SWORD_DAMAGE;
-                        // spawn hit sparks
-                        for (int si = 0; si < 6; ++si) {
-                            EffectParticle ep; ep.x = e.x + e.w*0.5f; ep.y = e.y + e.h*0.5f; ep.vx = (std::rand()%200 - 100) * 2.0f; ep.vy = (std::rand()%200 - 200) * 2.0f; ep.life = 0.25f + (std::rand()%100)/400.0f; ep.size = 1.0f + (std::rand()%3); ep.col = sf::Color(255,220,160); effectParticles.push_back(ep);
-                        }
-                        if (e.hp <= 0) {
-                            e.alive = false;
-                            e.vx = e.vy = 0.0f;
-                            e.respawnTimer = ENEMY_RESPAWN_BASE + (std::rand() % ((int)ENEMY_RESPAWN_VAR + 1));
-                        }
-                    }
-                }
-            }
-        }
-
-        // handle left-click attack trigger (edge): if pressed this frame and sword selected, trigger swing
-        bool curMouseLeftForEdge = sf::Mouse::isButtonPressed(sf::Mouse::Left);
-        if (curMouseLeftForEdge && !prevMouseLeft) {
-            if (p.selectedTool == "sword" && p.tools["sword"]>0) {
-                if (swingTimer <= 0.0f) { swingTimer = SWING_COOLDOWN; swingActive = SWING_ACTIVE; }
-            }
-        }
-        prevMouseLeft = curMouseLeftForEdge;
-
-        // actualizar invulnerabilidad del jugador
-        if (playerInvuln > 0.0f) playerInvuln = std::max(0.0f, playerInvuln - dt);
-        // actualizar timers de regeneración
-        timeSinceDamage += dt;
-        if (timeSinceDamage >= REGEN_DELAY_AFTER_DAMAGE) {
-            regenTimer += dt;
-            if (regenTimer >= REGEN_INTERVAL) {
-                if (playerHealth < MAX_HEALTH) playerHealth++;
-                regenTimer = 0.0f;
-            }
-        } else {
-            regenTimer = 0.0f;
-        }
-
-        // Death / respawn
-        if (playerHealth <= 0) {
-            // respawn at initial spawn
-            p.px = spawnPx; p.py = spawnPy; p.vx = 0.0f; p.vy = 0.0f;
-            playerHealth = MAX_HEALTH;
-            playerInvuln = 1.0f;
-            timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // delay regen after death
-            // reset fall tracking
-            wasOnGround = true;
-            lastGroundTile = static_cast<int>(std::floor((p.py + p.h) / TILE));
-            fallStartTile = lastGroundTile;
-        }
-
-        window.clear(skyColor);
-
         // actualizar cámara centrada en el jugador pero limitada al mapa
+        framePhase.stop(); // la cámara solo cuenta en "frame"
         float halfW = (float)VIEW_W_TILES * TILE * 0.5f * CAM_ZOOM;
         float halfH = (float)VIEW_H_TILES * TILE * 0.5f * CAM_ZOOM;
-        float mapPixelW = (float)W * TILE;
-        float mapPixelH = (float)H * TILE;
-        float desiredX = p.px + p.w*0.5f;
-        float desiredY = p.py + p.h*0.5f;
+        float mapPixelW = (float)world.width() * TILE;
+        float mapPixelH = (float)world.height() * TILE;
+        float desiredX = playerX + p.w*0.5f;
+        float desiredY = playerY + p.h*0.5f;
         float camX = std::min(std::max(desiredX, halfW), mapPixelW - halfW);
         float camY = std::min(std::max(desiredY, halfH), mapPixelH - halfH);
         // Smooth camera: interpolate current center towards desired using exponential smoothing
@@ -951,169 +1925,98 @@ int main(){
         float alpha = 1.0f - std::exp(-CAM_LERP * dt); // smoothing factor
         sf::Vector2f newCenter = curCenter + (desiredCenter - curCenter) * alpha;
         camera.setCenter(newCenter);
-
-        // dibujamos el mundo usando la cámara (culling por vista)
-        window.setView(camera);
-        {
-            sf::Vector2f c = camera.getCenter(); sf::Vector2f s = camera.getSize();
-            float left = c.x - s.x*0.5f; float top = c.y - s.y*0.5f;
-            int minX = std::max(0, (int)std::floor(left / TILE) - 1);
-            int minY = std::max(0, (int)std::floor(top / TILE) - 1);
-            int maxX = std::min(W-1, (int)std::ceil((left + s.x) / TILE) + 1);
-            int maxY = std::min(H-1, (int)std::ceil((top + s.y) / TILE) + 1);
-            for (int y=minY;y<=maxY;++y){
-                for (int x=minX;x<=maxX;++x){
-                    char b = get_block(world,x,y);
-                    sf::Color baseCol = color.count(b) ? color[b] : sf::Color::Magenta;
-                    sf::Color col((sf::Uint8)std::min(255.0f, baseCol.r * ambient), (sf::Uint8)std::min(255.0f, baseCol.g * ambient), (sf::Uint8)std::min(255.0f, baseCol.b * ambient));
-                    tileShape.setPosition(x*TILE, y*TILE);
-                    tileShape.setFillColor(col);
-                    window.draw(tileShape);
-                }
-            }
+        if (streamer) {
+            framePhase.next(ZONE_STREAM);
+            streamer->collect(world);
+            streamer->request_around(world, newCenter.x, newCenter.y, GEN_RADIUS);
         }
+        framePhase.next(ZONE_LIGHT);
+        g.light.update(world); // chunks recién llegados del streamer
+        // chunks aún sin luz (partida recién cargada) en la vista más un chunk de margen
+        g.light.light_view(world, TileRect{(int)std::floor((newCenter.x - halfW) / TILE) - CHUNK, (int)std::floor((newCenter.y - halfH) / TILE) - CHUNK,
+                                           (int)std::floor((newCenter.x + halfW) / TILE) + CHUNK, (int)std::floor((newCenter.y + halfH) / TILE) + CHUNK});
 
-        // Weather particles: spawn and update (in world coordinates)
+        framePhase.next(ZONE_TILES);
+        window.clear(skyColor);
+        // dibujamos el mundo usando la cámara: una malla cacheada por chunk visible (el aire no se dibuja)
+        window.setView(camera);
         {
             sf::Vector2f c = camera.getCenter(); sf::Vector2f s = camera.getSize();
-            float left = c.x - s.x*0.5f; float top = c.y - s.y*0.5f;
-            float right = left + s.x; float bottom = top + s.y;
-            // spawn accumulator
-            if (weatherMode == WEATHER_RAIN) {
-                weatherSpawnAcc += dt * WEATHER_RAIN_SPAWN_PER_SEC;
-                while (weatherSpawnAcc >= 1.0f) {
-                    weatherSpawnAcc -= 1.0f;
-                    WeatherParticle p0; p0.x = left + (std::rand() % (int)s.x); p0.y = top - 10.0f; p0.vy = 700.0f + (std::rand()%300); p0.life = (bottom - top) / p0.vy + 1.0f; p0.snow = false; weatherParticles.push_back(p0);
-                }
-            } else if (weatherMode == WEATHER_SNOW) {
-                weatherSpawnAcc += dt * WEATHER_SNOW_SPAWN_PER_SEC;
-                while (weatherSpawnAcc >= 1.0f) {
-                    weatherSpawnAcc -= 1.0f;
-                    WeatherParticle p0; p0.x = left + (std::rand() % (int)s.x); p0.y = top - 10.0f; p0.vy = 60.0f + (std::rand()%100); p0.life = (bottom - top) / p0.vy + 2.0f; p0.snow = true; weatherParticles.push_back(p0);
-                }
-            } else {
-                // no spawn
-            }
-            // update particles
-            for (int i = (int)weatherParticles.size()-1; i >= 0; --i) {
-                auto &wp = weatherParticles[i];
-                wp.y += wp.vy * dt;
-                wp.life -= dt;
-                if (wp.life <= 0.0f || wp.y > bottom + 20.0f) { weatherParticles.erase(weatherParticles.begin() + i); }
-            }
-            // draw particles
-            for (auto &wp : weatherParticles) {
-                if (wp.snow) {
-                    sf::CircleShape cs(2.0f);
-                    cs.setFillColor(sf::Color(240,240,255,220));
-                    cs.setPosition(wp.x, wp.y);
-                    window.draw(cs);
-                } else {
-                    sf::RectangleShape rs(sf::Vector2f(2.0f, 10.0f));
-                    rs.setFillColor(sf::Color(160,200,255,200));
-                    rs.setPosition(wp.x, wp.y);
-                    window.draw(rs);
-                }
-            }
+            tileRenderer.draw(window, world, sf::FloatRect(c.x - s.x*0.5f, c.y - s.y*0.5f, s.x, s.y), ambient);
         }
 
-        // Effect particles update & draw (sparks, explosion debris)
-        for (int i = (int)effectParticles.size()-1; i >= 0; --i) {
-            auto &ep = effectParticles[i];
-            ep.x += ep.vx * dt; ep.y += ep.vy * dt; ep.vy += 800.0f * dt; // light gravity
-            ep.life -= dt;
-            if (ep.life <= 0.0f) { effectParticles.erase(effectParticles.begin() + i); continue; }
-            sf::CircleShape cs(ep.size);
-            sf::Color c = ep.col; float a = std::max(0.0f, ep.life);
-            c.a = (sf::Uint8)(255.0f * std::min(1.0f, a));
-            cs.setFillColor(c);
-            cs.setPosition(ep.x, ep.y);
-            window.draw(cs);
-        }
+        framePhase.next(ZONE_ENTITIES);
+        // Partículas de clima y de efectos (en coordenadas del mundo): un solo lote y una llamada
+        particleBatch.clear();
+        g.weatherParticles.add_to(particleBatch, atlas.region(TextureAtlas::WHITE), false);
+        g.effectParticles.add_to(particleBatch, atlas.region(TextureAtlas::WHITE), true);
+        particleBatch.draw(window, atlas);
 
         // mostrar progreso de picar si aplica (en coordenadas del mundo, con la cámara activa)
-        if (breaking && breakX>=0 && breakY>=0) {
+        if (g.breaking && g.breakX>=0 && g.breakY>=0) {
             sf::RectangleShape overlay(sf::Vector2f(TILE, TILE));
-            overlay.setPosition(breakX * TILE, breakY * TILE);
+            overlay.setPosition(g.breakX * TILE, g.breakY * TILE);
             overlay.setFillColor(sf::Color(0,0,0,80));
             window.draw(overlay);
             // barra de progreso
-            char tb = get_block(world, breakX, breakY);
-            float mult = 1.0f;
-            if (tb == (char)STONE) mult = 2.0f;
-            else if (tb == (char)WOOD) mult = 0.8f;
-            else if (tb == (char)LEAF) mult = 0.4f;
-            else if (tb == (char)COAL) mult = 1.2f;
-            else if (tb == (char)IRON) mult = 3.0f;
-            else if (tb == (char)GOLD) mult = 4.0f;
-            float need = BASE_BREAK_TIME * mult;
-            float ratio = std::min(1.0f, breakProgress / (need + 1e-6f));
+            BlockId tb = get_block(world, g.breakX, g.breakY);
+            float need = BASE_BREAK_TIME * std::max(0.0f, break_time_multiplier(tb, held_tool(p)));
+            float ratio = std::min(1.0f, g.breakProgress / (need + 1e-6f));
             sf::RectangleShape barBg(sf::Vector2f(TILE-6, 8));
-            barBg.setPosition(breakX * TILE + 3, breakY * TILE + TILE - 12);
+            barBg.setPosition(g.breakX * TILE + 3, g.breakY * TILE + TILE - 12);
             barBg.setFillColor(sf::Color(0,0,0,160));
             window.draw(barBg);
             sf::RectangleShape bar(sf::Vector2f((TILE-6) * ratio, 8));
-            bar.setPosition(breakX * TILE + 3, breakY * TILE + TILE - 12);
+            bar.setPosition(g.breakX * TILE + 3, g.breakY * TILE + TILE - 12);
             bar.setFillColor(sf::Color::Green);
             window.draw(bar);
         }
 
-        // draw enemies (con cámara activa) - usar texturas si están disponibles
-        for (auto &e : enemies) {
-            if (!e.alive) continue;
-            std::vector<std::string> candidates;
-            if (e.type == Enemy::ZOMBIE) candidates = {"zombie"};
-            else if (e.type == Enemy::SKELETON) candidates = {"skeleton", "esqueleto"};
-            else if (e.type == Enemy::SPIDER) candidates = {"spider", "araña", "arana"};
-            else if (e.type == Enemy::CREEPER) candidates = {"creeper", "crepe"};
-
-            std::string useKey;
-            for (auto &c : candidates) if (textures.count(c)) { useKey = c; break; }
-
-            if (!useKey.empty()) {
-                sf::Sprite s;
-                s.setTexture(textures[useKey]);
-                auto &t = textures[useKey];
-                if (t.getSize().x > 0 && t.getSize().y > 0) s.setScale(e.w / (float)t.getSize().x, e.h / (float)t.getSize().y);
-                s.setPosition(e.x, e.y);
-                // modulate sprite color by ambient
-                sf::Color mod((sf::Uint8)std::min(255.0f, 255.0f * ambient), (sf::Uint8)std::min(255.0f, 255.0f * ambient), (sf::Uint8)std::min(255.0f, 255.0f * ambient));
-                s.setColor(mod);
-                window.draw(s);
-            } else {
-                sf::Color base;
-                if (e.type == Enemy::ZOMBIE) base = sf::Color(50,200,50);
-                else if (e.type == Enemy::SKELETON) base = sf::Color(230,230,230);
-                else if (e.type == Enemy::SPIDER) base = sf::Color(20,20,20);
-                else if (e.type == Enemy::CREEPER) { base = (e.fuseTimer > 0.0f) ? sf::Color(255,180,80) : sf::Color(40,200,40); }
-                sf::Color col((sf::Uint8)std::min(255.0f, base.r * ambient), (sf::Uint8)std::min(255.0f, base.g * ambient), (sf::Uint8)std::min(255.0f, base.b * ambient));
-                enemyShape.setFillColor(col);
-                enemyShape.setPosition(e.x, e.y);
-                window.draw(enemyShape);
+        // draw enemies + player (con cámara activa) en un solo lote; sin textura se usa el bloque blanco del atlas teñido
+        {
+            // cada entidad toma la luz del tile de su centro
+            auto brightnessAt = [&](float x, float y, float w, float h) {
+                return light_brightness(world.light_at((int)std::floor((x + w*0.5f) / TILE), (int)std::floor((y + h*0.5f) / TILE)), ambient);
+            };
+            auto shade = [](const sf::Color &base, float k){ return sf::Color((sf::Uint8)std::min(255.0f, base.r * k), (sf::Uint8)std::min(255.0f, base.g * k), (sf::Uint8)std::min(255.0f, base.b * k)); };
+            entityBatch.clear();
+            // objetos sueltos (con la textura de su bloque si la hay)
+            for (const ItemDrop &d : g.drops) {
+                float k = brightnessAt(d.x, d.y, DROP_SIZE, DROP_SIZE);
+                if (blockTex[d.block] >= 0) entityBatch.add(d.x, d.y, DROP_SIZE, DROP_SIZE, atlas.region(blockTex[d.block]), shade(sf::Color::White, k));
+                else entityBatch.add(d.x, d.y, DROP_SIZE, DROP_SIZE, atlas.region(TextureAtlas::WHITE), shade(block_color(d.block), k));
             }
-        }
-
-        // draw player (sprite if available)
-        if (playerHasTexture) {
-            playerSprite.setPosition(p.px, p.py);
-            sf::Color pmod((sf::Uint8)std::min(255.0f, 255.0f * ambient), (sf::Uint8)std::min(255.0f, 255.0f * ambient), (sf::Uint8)std::min(255.0f, 255.0f * ambient));
-            playerSprite.setColor(pmod);
-            window.draw(playerSprite);
-        } else {
-            sf::Color baseP = playerShape.getFillColor();
-            sf::Color pcol((sf::Uint8)std::min(255.0f, baseP.r * ambient), (sf::Uint8)std::min(255.0f, baseP.g * ambient), (sf::Uint8)std::min(255.0f, baseP.b * ambient));
-            playerShape.setFillColor(pcol);
-            playerShape.setPosition(p.px, p.py);
-            window.draw(playerShape);
-            // restore base color for future frames
-            playerShape.setFillColor(baseP);
+            // solo los enemigos dentro de la vista (más el movimiento de un tick)
+            sf::Vector2f vc = camera.getCenter(), vs = camera.getSize();
+            float margin = 2.0f * TILE;
+            for (std::uint32_t id : enemies_near(g, vc.x - vs.x*0.5f - margin, vc.y - vs.y*0.5f - margin, vc.x + vs.x*0.5f + margin, vc.y + vs.y*0.5f + margin)) {
+                EnemyRef e = enemies.ref(id);
+                int tex = enemyTex[e.type];
+                float ex = lerpF(e.prevX, e.x), ey = lerpF(e.prevY, e.y);
+                float k = brightnessAt(ex, ey, e.w, e.h);
+                if (tex >= 0) {
+                    entityBatch.add(ex, ey, e.w, e.h, atlas.region(tex), shade(sf::Color::White, k));
+                } else {
+                    sf::Color base;
+                    if (e.type == Enemy::ZOMBIE) base = sf::Color(50,200,50);
+                    else if (e.type == Enemy::SKELETON) base = sf::Color(230,230,230);
+                    else if (e.type == Enemy::SPIDER) base = sf::Color(20,20,20);
+                    else if (e.type == Enemy::CREEPER) { base = (e.fuseTimer > 0.0f) ? sf::Color(255,180,80) : sf::Color(40,200,40); }
+                    entityBatch.add(ex, ey, e.w, e.h, atlas.region(TextureAtlas::WHITE), shade(base, k));
+                }
+            }
+            // player (sprite if available)
+            float pk = brightnessAt(playerX, playerY, p.w, p.h);
+            if (playerTex >= 0) entityBatch.add(playerX, playerY, p.w, p.h, atlas.region(playerTex), shade(sf::Color::White, pk));
+            else entityBatch.add(playerX, playerY, p.w, p.h, atlas.region(TextureAtlas::WHITE), shade(sf::Color::Yellow, pk));
+            entityBatch.draw(window, atlas);
         }
 
         // draw sword swing area (visible while active)
-        if (swingActive > 0.0f) {
-            float attackX = (p.fx >= 0) ? (p.px + p.w) : (p.px - SWING_RANGE);
+        if (g.swingActive > 0.0f) {
+            float attackX = (p.fx >= 0) ? (playerX + p.w) : (playerX - SWING_RANGE);
             sf::RectangleShape atk(sf::Vector2f(SWING_RANGE, p.h));
-            atk.setPosition(attackX, p.py);
+            atk.setPosition(attackX, playerY);
             atk.setFillColor(sf::Color(255,255,255,90));
             window.draw(atk);
         }
@@ -1132,188 +2035,240 @@ int main(){
             window.draw(orb);
         }
 
+        framePhase.next(ZONE_HUD);
         // HUD: cambiar a vista por defecto para dibujar elementos de interfaz en pantalla
         window.setView(window.getDefaultView());
-        sf::RectangleShape hudBg(sf::Vector2f((float)VIEW_W_TILES * TILE, (float)HUD_HEIGHT));
-        hudBg.setPosition(0, (float)VIEW_H_TILES * TILE);
-        hudBg.setFillColor(sf::Color(30,30,30,200));
-        window.draw(hudBg);
-
-        // Draw player hearts
-        const float heartSize = 20.0f;
-        for (int i = 0; i < MAX_HEALTH; ++i) {
-            sf::RectangleShape heart(sf::Vector2f(heartSize, heartSize));
-            heart.setPosition(10 + i * (heartSize + 6), 8); // hearts at top
-            if (i < playerHealth) heart.setFillColor(sf::Color(220,30,30));
-            else { heart.setFillColor(sf::Color(80,80,80)); heart.setOutlineThickness(2); heart.setOutlineColor(sf::Color(30,30,30)); }
-            // flash when invulnerable
-            if (playerInvuln > 0.0f) { sf::Color c = heart.getFillColor(); c.a = 180; heart.setFillColor(c); }
-            window.draw(heart);
-        }
+        auto drawHud = [&](sf::RenderTarget &target) {
+            sf::RectangleShape hudBg(sf::Vector2f((float)VIEW_W_TILES * TILE, (float)HUD_HEIGHT));
+            hudBg.setPosition(0, (float)VIEW_H_TILES * TILE);
+            hudBg.setFillColor(sf::Color(30,30,30,200));
+            target.draw(hudBg);
+
+            // Draw player hearts
+            const float heartSize = 20.0f;
+            for (int i = 0; i < MAX_HEALTH; ++i) {
+                sf::RectangleShape heart(sf::Vector2f(heartSize, heartSize));
+                heart.setPosition(10 + i * (heartSize + 6), 8); // hearts at top
+                if (i < g.playerHealth) heart.setFillColor(sf::Color(220,30,30));
+                else { heart.setFillColor(sf::Color(80,80,80)); heart.setOutlineThickness(2); heart.setOutlineColor(sf::Color(30,30,30)); }
+                // flash when invulnerable
+                if (g.playerInvuln > 0.0f) { sf::Color c = heart.getFillColor(); c.a = 180; heart.setFillColor(c); }
+                target.draw(heart);
+            }
 
-        // tools HUD: show pickaxe/axe/shovel with keys Q/E/R below hearts
-        {
-            int ti = 0;
-            std::vector<std::pair<std::string,char>> toolOrder = {{"pickaxe",'Q'},{"axe",'E'},{"shovel",'R'},{"sword",'T'}};
-            for (auto &pr : toolOrder){
-                std::string tool = pr.first; char key = pr.second;
-                sf::RectangleShape tslot(sf::Vector2f(36,36));
-                tslot.setPosition(10 + ti*42, 40);
-                tslot.setFillColor(sf::Color(0,0,0,160));
-                window.draw(tslot);
-                sf::Text lab(std::string(1,key) + ":" + tool.substr(0,3), font, 14);
-                lab.setPosition(14 + ti*42, 42);
-                lab.setFillColor(sf::Color::White);
-                window.draw(lab);
-                // highlight selected tool
-                if (p.selectedTool == tool){
-                    sf::RectangleShape high(sf::Vector2f(40,40));
-                    high.setPosition(8 + ti*42, 38);
-                    high.setFillColor(sf::Color(255,255,255,40));
-                    window.draw(high);
+            // tools HUD: show pickaxe/axe/shovel with keys Q/E/R below hearts
+            {
+                int ti = 0;
+                std::vector<std::pair<Tool,char>> toolOrder = {{TOOL_PICKAXE,'Q'},{TOOL_AXE,'E'},{TOOL_SHOVEL,'R'},{TOOL_SWORD,'T'}};
+                for (auto &pr : toolOrder){
+                    Tool tool = pr.first; char key = pr.second;
+                    sf::RectangleShape tslot(sf::Vector2f(36,36));
+                    tslot.setPosition(10 + ti*42, 40);
+                    tslot.setFillColor(sf::Color(0,0,0,160));
+                    target.draw(tslot);
+                    sf::Text lab(std::string(1,key) + ":" + std::string(TOOL_INFO[tool].id).substr(0,3), font, 14);
+                    lab.setPosition(14 + ti*42, 42);
+                    lab.setFillColor(sf::Color::White);
+                    target.draw(lab);
+                    // highlight selected tool
+                    if (p.selectedTool == tool){
+                        sf::RectangleShape high(sf::Vector2f(40,40));
+                        high.setPosition(8 + ti*42, 38);
+                        high.setFillColor(sf::Color(255,255,255,40));
+                        target.draw(high);
+                    }
+                    ti++;
                 }
-                ti++;
             }
-        }
 
-        // Selected tool/block panel (top-right) - improved layout to avoid overlapping text
-        {
-            float screenW = (float)VIEW_W_TILES * TILE;
-            float px = screenW - 280.0f;
-            float py = 8.0f;
-            sf::RectangleShape panel(sf::Vector2f(268.0f, 96.0f));
-            panel.setPosition(px, py);
-            panel.setFillColor(sf::Color(20,20,20,220));
-            panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(80,80,80));
-            window.draw(panel);
-            // selected block big slot
-            sf::RectangleShape bslot(sf::Vector2f(64,64));
-            bslot.setPosition(px + 8, py + 12);
-            char sb = p.selected;
-            sf::Color scol = color.count(sb) ? color[sb] : sf::Color(140,140,140);
-            bslot.setFillColor(scol);
-            bslot.setOutlineThickness(2); bslot.setOutlineColor(sf::Color::Black);
-            window.draw(bslot);
-            // block name
-            std::string bname = blockNames.count(sb) ? blockNames[sb] : std::string(1, sb);
-            sf::Text bnameText(bname, font, 18);
-            bnameText.setFillColor(sf::Color::White);
-            bnameText.setPosition(px + 82, py + 16);
-            window.draw(bnameText);
-            // count below name
-            sf::Text cnt(std::to_string(p.inv[sb]), font, 16);
-            cnt.setFillColor(sf::Color::White);
-            cnt.setPosition(px + 82, py + 40);
-            window.draw(cnt);
-            // tool area label and content (separated lines to avoid overlap)
-            sf::Text tlabel("Herramienta:", font, 13);
-            tlabel.setFillColor(sf::Color::White);
-            tlabel.setPosition(px + 82, py + 56);
-            window.draw(tlabel);
-            // draw tool icon if available, else draw name on its own line
-            std::string toolName = toolNames.count(p.selectedTool) ? toolNames[p.selectedTool] : (p.selectedTool.empty() ? "(none)" : p.selectedTool);
-            if (!p.selectedTool.empty() && textures.count(p.selectedTool)) {
-                sf::Sprite ts; ts.setTexture(textures[p.selectedTool]);
-                auto &tt = textures[p.selectedTool]; if (tt.getSize().x>0 && tt.getSize().y>0) ts.setScale(48.0f / (float)tt.getSize().x, 48.0f / (float)tt.getSize().y);
-                ts.setPosition(px + 188, py + 24); window.draw(ts);
-                // also draw name below the label for clarity
-                sf::Text tl(toolName, font, 14); tl.setFillColor(sf::Color::White); tl.setPosition(px + 82, py + 74); window.draw(tl);
-            } else {
-                sf::Text tl(toolName, font, 16); tl.setFillColor(sf::Color::White); tl.setPosition(px + 82, py + 72); window.draw(tl);
+            // Selected tool/block panel (top-right) - improved layout to avoid overlapping text
+            {
+                float screenW = (float)VIEW_W_TILES * TILE;
+                float px = screenW - 280.0f;
+                float py = 8.0f;
+                sf::RectangleShape panel(sf::Vector2f(268.0f, 96.0f));
+                panel.setPosition(px, py);
+                panel.setFillColor(sf::Color(20,20,20,220));
+                panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(80,80,80));
+                target.draw(panel);
+                // selected block big slot
+                sf::RectangleShape bslot(sf::Vector2f(64,64));
+                bslot.setPosition(px + 8, py + 12);
+                BlockId sb = p.selected;
+                sf::Color scol = block_color(sb);
+                bslot.setFillColor(scol);
+                bslot.setOutlineThickness(2); bslot.setOutlineColor(sf::Color::Black);
+                target.draw(bslot);
+                // block name
+                std::string bname = block_traits(sb).name;
+                sf::Text bnameText(bname, font, 18);
+                bnameText.setFillColor(sf::Color::White);
+                bnameText.setPosition(px + 82, py + 16);
+                target.draw(bnameText);
+                // count below name
+                sf::Text cnt(std::to_string(p.inv.count(sb)), font, 16);
+                cnt.setFillColor(sf::Color::White);
+                cnt.setPosition(px + 82, py + 40);
+                target.draw(cnt);
+                // tool area label and content (separated lines to avoid overlap)
+                sf::Text tlabel("Herramienta:", font, 13);
+                tlabel.setFillColor(sf::Color::White);
+                tlabel.setPosition(px + 82, py + 56);
+                target.draw(tlabel);
+                // draw tool icon if available, else draw name on its own line
+                std::string toolName = TOOL_INFO[p.selectedTool].name;
+                int toolIcon = toolTex[p.selectedTool];
+                if (toolIcon >= 0) {
+                    const sf::IntRect &tr = atlas.region(toolIcon);
+                    sf::Sprite ts(atlas.getTexture(), tr);
+                    if (tr.width>0 && tr.height>0) ts.setScale(48.0f / (float)tr.width, 48.0f / (float)tr.height);
+                    ts.setPosition(px + 188, py + 24); target.draw(ts);
+                    // also draw name below the label for clarity
+                    sf::Text tl(toolName, font, 14); tl.setFillColor(sf::Color::White); tl.setPosition(px + 82, py + 74); target.draw(tl);
+                } else {
+                    sf::Text tl(toolName, font, 16); tl.setFillColor(sf::Color::White); tl.setPosition(px + 82, py + 72); target.draw(tl);
+                }
             }
-        }
 
-        // inventory (extendido con hojas, minerales y nuevos bloques)
-        {
-            std::vector<char> mapSel = {(char)GRASS,(char)DIRT,(char)STONE,(char)WOOD,(char)LEAF,(char)COAL,(char)IRON,(char)GOLD,(char)SAND,(char)SNOW,(char)NETH,(char)LAVA};
-            int slots = std::min((int)mapSel.size(), INV_SLOTS);
-            for (int i=0;i<slots;++i){
-                char b = mapSel[i];
-                sf::RectangleShape slot(sf::Vector2f(56,56));
-                slot.setPosition(10 + i*66, VIEW_H_TILES * TILE + 16);
-                sf::Color col = color.count(b) ? color[b] : sf::Color(100,100,100);
-                slot.setFillColor(col);
-                if (b==p.selected) { slot.setOutlineThickness(3); slot.setOutlineColor(sf::Color::Yellow); }
-                else { slot.setOutlineThickness(1); slot.setOutlineColor(sf::Color::Black); }
-                window.draw(slot);
-                sf::Text t(std::to_string(p.inv[b]), font, 16);
-                t.setFillColor(sf::Color::White);
-                t.setPosition(10 + i*66 + 34, VIEW_H_TILES * TILE + 56);
-                window.draw(t);
+            // inventory (extendido con hojas, minerales y nuevos bloques)
+            {
+                int slots = std::min((int)HOTBAR.size(), INV_SLOTS);
+                for (int i=0;i<slots;++i){
+                    BlockId b = HOTBAR[i];
+                    sf::RectangleShape slot(sf::Vector2f(56,56));
+                    slot.setPosition(10 + i*66, VIEW_H_TILES * TILE + 16);
+                    sf::Color col = block_color(b);
+                    slot.setFillColor(col);
+                    if (b==p.selected) { slot.setOutlineThickness(3); slot.setOutlineColor(sf::Color::Yellow); }
+                    else { slot.setOutlineThickness(1); slot.setOutlineColor(sf::Color::Black); }
+                    target.draw(slot);
+                    sf::Text t(std::to_string(p.inv.count(b)), font, 16);
+                    t.setFillColor(sf::Color::White);
+                    t.setPosition(10 + i*66 + 34, VIEW_H_TILES * TILE + 56);
+                    target.draw(t);
+                }
             }
-        }
 
-        // block picker overlay
-        if (showBlockPicker) {
-            // darken background
-            sf::RectangleShape dark(sf::Vector2f((float)VIEW_W_TILES * TILE, (float)VIEW_H_TILES * TILE));
-            dark.setFillColor(sf::Color(0,0,0,140));
-            dark.setPosition(0,0);
-            window.draw(dark);
-            // draw centered panel with block options
-            std::vector<char> picker = {(char)GRASS,(char)DIRT,(char)STONE,(char)WOOD,(char)LEAF,(char)COAL,(char)IRON,(char)GOLD,(char)SAND,(char)SNOW,(char)NETH,(char)LAVA};
-            int cols = 4; int rows = (picker.size() + cols - 1) / cols;
-            float slotW = 80.0f, slotH = 80.0f, gap = 12.0f;
-            float panelW = cols * slotW + (cols-1)*gap;
-            float panelH = rows * slotH + (rows-1)*gap;
-            sf::Vector2f center((float)VIEW_W_TILES * TILE * 0.5f, (float)VIEW_H_TILES * TILE * 0.5f);
-            float startX = center.x - panelW*0.5f; float startY = center.y - panelH*0.5f;
-            for (int i=0;i<(int)picker.size();++i){
-                int r = i / cols; int c = i % cols;
-                float sx = startX + c * (slotW + gap);
-                float sy = startY + r * (slotH + gap);
-                sf::RectangleShape slot(sf::Vector2f(slotW, slotH));
-                slot.setPosition(sx, sy);
-                char b = picker[i];
-                sf::Color col = color.count(b) ? color[b] : sf::Color(120,120,120);
-                slot.setFillColor(col);
-                slot.setOutlineThickness(2); slot.setOutlineColor(sf::Color::White);
-                window.draw(slot);
-                // label
-                sf::Text lab(std::string(1, b), font, 20);
-                lab.setFillColor(sf::Color::Black);
-                lab.setPosition(sx + 8, sy + 8);
-                window.draw(lab);
+            // block picker overlay
+            if (showBlockPicker) {
+                // darken background
+                sf::RectangleShape dark(sf::Vector2f((float)VIEW_W_TILES * TILE, (float)VIEW_H_TILES * TILE));
+                dark.setFillColor(sf::Color(0,0,0,140));
+                dark.setPosition(0,0);
+                target.draw(dark);
+                // draw centered panel with block options
+                int cols = 4; int rows = ((int)HOTBAR.size() + cols - 1) / cols;
+                float slotW = 80.0f, slotH = 80.0f, gap = 12.0f;
+                float panelW = cols * slotW + (cols-1)*gap;
+                float panelH = rows * slotH + (rows-1)*gap;
+                sf::Vector2f center((float)VIEW_W_TILES * TILE * 0.5f, (float)VIEW_H_TILES * TILE * 0.5f);
+                float startX = center.x - panelW*0.5f; float startY = center.y - panelH*0.5f;
+                for (int i=0;i<(int)HOTBAR.size();++i){
+                    int r = i / cols; int c = i % cols;
+                    float sx = startX + c * (slotW + gap);
+                    float sy = startY + r * (slotH + gap);
+                    sf::RectangleShape slot(sf::Vector2f(slotW, slotH));
+                    slot.setPosition(sx, sy);
+                    BlockId b = HOTBAR[i];
+                    sf::Color col = block_color(b);
+                    slot.setFillColor(col);
+                    slot.setOutlineThickness(2); slot.setOutlineColor(sf::Color::White);
+                    target.draw(slot);
+                    // label
+                    sf::Text lab(block_traits(b).name, font, 14);
+                    lab.setFillColor(sf::Color::Black);
+                    lab.setPosition(sx + 8, sy + 8);
+                    target.draw(lab);
+                }
             }
-        }
 
-        // Help panel (toggle with H)
-        if (showHelp) {
-            std::vector<std::string> helpLines = {
-                "Controles:",
-                "A/D: mover    W/Espacio: saltar",
-                "X: picar (mantener)    C/Dcho: colocar",
-                "Q: Pico    E: Hacha    R: Pala    T: Espada",
-                "1-0: seleccionar bloques    F: elegir bloque (overlay)",
-                "K: alternar clima    H: cerrar esta ayuda"
-            };
-            float panelW = 560.0f;
-            float lineH = 22.0f;
-            float panelH = (float)helpLines.size() * lineH + 20.0f;
-            float startX = ((float)VIEW_W_TILES * TILE - panelW) * 0.5f;
-            float startY = ((float)VIEW_H_TILES * TILE - panelH) * 0.5f;
-            sf::RectangleShape panel(sf::Vector2f(panelW, panelH));
-            panel.setPosition(startX, startY);
-            panel.setFillColor(sf::Color(10,10,10,220));
-            panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(120,120,120));
-            window.draw(panel);
-            for (size_t i = 0; i < helpLines.size(); ++i) {
-                sf::Text t(helpLines[i], font, 18);
-                t.setFillColor(sf::Color::White);
-                t.setPosition(startX + 12.0f, startY + 8.0f + i * lineH);
-                window.draw(t);
+            // crafting panel (G): recetas que se pueden fabricar en blanco, el resto en gris
+            if (showCrafting) {
+                sf::FloatRect top = craft_row_rect(-1);
+                sf::RectangleShape panel(sf::Vector2f(CRAFT_PANEL_W, (RECIPE_COUNT + 1) * CRAFT_ROW_H + 16.0f));
+                panel.setPosition(top.left, top.top - 8.0f);
+                panel.setFillColor(sf::Color(10,10,10,220));
+                panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(120,120,120));
+                target.draw(panel);
+                sf::Text title("Fabricar (G para cerrar)", font, 18);
+                title.setFillColor(sf::Color::White);
+                title.setPosition(top.left + 12.0f, top.top);
+                target.draw(title);
+                for (int r = 0; r < RECIPE_COUNT; ++r) {
+                    sf::FloatRect row = craft_row_rect(r);
+                    sf::Text t(recipe_label(RECIPES[r]), font, 16);
+                    t.setFillColor(p.inv.can_craft(r) ? sf::Color::White : sf::Color(110,110,110));
+                    t.setPosition(row.left + 12.0f, row.top + 4.0f);
+                    target.draw(t);
+                }
+            }
+
+            // Help panel (toggle with H)
+            if (showHelp) {
+                std::vector<std::string> helpLines = {
+                    "Controles:",
+                    "A/D: mover    W/Espacio: saltar",
+                    "X: picar (mantener)    C/Dcho: colocar",
+                    "Q: Pico    E: Hacha    R: Pala    T: Espada",
+                    "1-0: seleccionar bloques    F: elegir bloque (overlay)",
+                    "G: fabricar (clic en una receta)    K: alternar clima",
+                    "F3: tiempos por fase    F4: guardar traza    H: cerrar esta ayuda",
+                    "F5: guardar    F9: cargar (autoguardado, y al cerrar)"
+                };
+                float panelW = 560.0f;
+                float lineH = 22.0f;
+                float panelH = (float)helpLines.size() * lineH + 20.0f;
+                float startX = ((float)VIEW_W_TILES * TILE - panelW) * 0.5f;
+                float startY = ((float)VIEW_H_TILES * TILE - panelH) * 0.5f;
+                sf::RectangleShape panel(sf::Vector2f(panelW, panelH));
+                panel.setPosition(startX, startY);
+                panel.setFillColor(sf::Color(10,10,10,220));
+                panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(120,120,120));
+                target.draw(panel);
+                for (size_t i = 0; i < helpLines.size(); ++i) {
+                    sf::Text t(helpLines[i], font, 18);
+                    t.setFillColor(sf::Color::White);
+                    t.setPosition(startX + 12.0f, startY + 8.0f + i * lineH);
+                    target.draw(t);
+                }
+            }
+        };
+        HudState hud = hud_state(g, showBlockPicker, showHelp, showCrafting);
+        if (!hudCached) drawHud(window);
+        else {
+            if (!hudValid || hud != hudShown) {
+                hudLayer.clear(sf::Color::Transparent);
+                drawHud(hudLayer);
+                hudLayer.display();
+                hudShown = hud;
+                hudValid = true;
             }
+            // la textura guarda color ya multiplicado por alfa (se dibujó con mezcla alfa sobre transparente)
+            sf::Sprite hudSprite(hudLayer.getTexture());
+            window.draw(hudSprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha)));
         }
 
         // FPS
-        float fps = (dt > 0.0001f) ? (1.f / dt) : 0.f;
-        fpsText.setString(std::to_string((int)fps) + " FPS");
+        fpsTimer += dt;
+        fpsFrames++;
+        if (fpsTimer >= 0.25f) {
+            fpsText.setString(std::to_string((int)(fpsFrames / fpsTimer)) + " FPS");
+            fpsTimer = 0.0f;
+            fpsFrames = 0;
+        }
         fpsText.setPosition((float)VIEW_W_TILES * TILE - 90.f, VIEW_H_TILES * TILE + 4.f);
         window.draw(fpsText);
+        if (showProfiler) draw_profiler_overlay(window, font, frameProf, tileRenderer.draw_calls(), 10.0f, 90.0f);
 
         // (No HUD de vida ni manejo de Game Over en esta versión)
 
+        framePhase.next(ZONE_DISPLAY);
         window.display();
     }
+    stopRecording();
+    streamer.reset(); // parar los hilos de generación antes de guardar
+    autosave(true);
+    autosaver.flush();
+    if (autosaver.failed()) std::cerr << "Aviso: no pude guardar en " << DEFAULT_SAVE_PATH << std::endl;
     return 0;
 }